@@ -0,0 +1,154 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <array>
+#include <string>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <chrono>
+using namespace std;
+
+// 1 つの並び替えについて評価する計算式の個数 (64 通りの演算子 × 5 通りの形)
+const int NUM_OPS = 64;
+const int NUM_SHAPES = 5;
+const int NUM_LANES = NUM_OPS * NUM_SHAPES;
+
+// 以下の関数は、演算子ごとに n 個の値へ同じ演算を分岐なしで適用する
+// 演算子 k (0: +, 1: -, 2: *, 3: /) の結果を out[k * n + i] に格納する
+// (コンパイラの自動ベクトル化により、各ループが SIMD 命令で処理される)
+
+// out[k * n + i] = x[i] op_k y[i]
+inline void apply_ops(const double* x, const double* y, int n, double* out) {
+    for (int i = 0; i < n; ++i) out[i] = x[i] + y[i];
+    for (int i = 0; i < n; ++i) out[n + i] = x[i] - y[i];
+    for (int i = 0; i < n; ++i) out[2 * n + i] = x[i] * y[i];
+    for (int i = 0; i < n; ++i) out[3 * n + i] = x[i] / y[i];
+}
+
+// out[k * n + i] = x[i] op_k y
+inline void apply_ops_left(const double* x, double y, int n, double* out) {
+    for (int i = 0; i < n; ++i) out[i] = x[i] + y;
+    for (int i = 0; i < n; ++i) out[n + i] = x[i] - y;
+    for (int i = 0; i < n; ++i) out[2 * n + i] = x[i] * y;
+    for (int i = 0; i < n; ++i) out[3 * n + i] = x[i] / y;
+}
+
+// out[k * n + i] = x op_k y[i]
+inline void apply_ops_right(double x, const double* y, int n, double* out) {
+    for (int i = 0; i < n; ++i) out[i] = x + y[i];
+    for (int i = 0; i < n; ++i) out[n + i] = x - y[i];
+    for (int i = 0; i < n; ++i) out[2 * n + i] = x * y[i];
+    for (int i = 0; i < n; ++i) out[3 * n + i] = x / y[i];
+}
+
+// 並び替え (a, b, c, d) に対する 320 通りの計算式の値をまとめて求める
+// 0 除算は inf や nan になるが、作りたい数と一致しないので分岐は不要である
+void evaluate(double a, double b, double c, double d, double* res) {
+    double t1[4], t2[16], u1[4], x16[16], y16[16];
+
+    // パターン "xxxxooo": a o3 (b o2 (c o1 d))
+    apply_ops_right(c, &d, 1, t1);
+    apply_ops_right(b, t1, 4, t2);
+    apply_ops_right(a, t2, 16, res);
+
+    // パターン "xxxoxoo": a o3 ((b o1 c) o2 d)
+    apply_ops_right(b, &c, 1, t1);
+    apply_ops_left(t1, d, 4, t2);
+    apply_ops_right(a, t2, 16, res + NUM_OPS);
+
+    // パターン "xxxooxo": (a o2 (b o1 c)) o3 d
+    apply_ops_right(a, t1, 4, t2);
+    apply_ops_left(t2, d, 16, res + 2 * NUM_OPS);
+
+    // パターン "xxoxoxo": ((a o1 b) o2 c) o3 d
+    apply_ops_right(a, &b, 1, t1);
+    apply_ops_left(t1, c, 4, t2);
+    apply_ops_left(t2, d, 16, res + 3 * NUM_OPS);
+
+    // パターン "xxoxxoo": (a o1 b) o3 (c o2 d)
+    apply_ops_right(c, &d, 1, u1);
+    for (int i = 0; i < 16; ++i) x16[i] = t1[i % 4], y16[i] = u1[i / 4];
+    apply_ops(x16, y16, 16, res + 4 * NUM_OPS);
+}
+
+// 320 通りの値のうち、作りたい数 target に一致するものの個数を数える
+inline int count_hits(const double* res, double target) {
+    const double EPS = 1e-9;  // 十分小さい値
+    int cnt = 0;
+    for (int i = 0; i < NUM_LANES; ++i)
+        cnt += (abs(res[i] - target) < EPS);
+    return cnt;
+}
+
+int main(int argc, char** argv) {
+    // 作りたい数、手札に使う数の範囲、スレッド数 (いずれも省略可能)
+    // 使い方: bulk_scanner [target] [min value] [max value] [threads] [--list]
+    int target = argc >= 2 ? stoi(argv[1]) : 10;
+    int min_val = argc >= 3 ? stoi(argv[2]) : 0;
+    int max_val = argc >= 4 ? stoi(argv[3]) : 9;
+    int num_threads = argc >= 5 ? stoi(argv[4]) : thread::hardware_concurrency();
+    bool list = argc >= 6 && string(argv[5]) == "--list";
+    if (num_threads <= 0) num_threads = 1;
+
+    // すべての手札 (4 つの数の多重集合) と、その並び替えを列挙する
+    vector<array<int, 4>> hands;
+    vector<pair<int, array<int, 4>>> works;  // (手札の番号, 並び替え)
+    for (int a = min_val; a <= max_val; ++a) {
+        for (int b = a; b <= max_val; ++b) {
+            for (int c = b; c <= max_val; ++c) {
+                for (int d = c; d <= max_val; ++d) {
+                    array<int, 4> hand = {a, b, c, d};
+                    do {
+                        works.emplace_back(hands.size(), hand);
+                    } while (next_permutation(hand.begin(), hand.end()));
+                    hands.push_back({a, b, c, d});
+                }
+            }
+        }
+    }
+
+    // 並び替えをスレッドに分配する (各スレッドは手札ごとの個数を別々に数える)
+    const int CHUNK = 256;  // 1 回に取り出す並び替えの個数
+    atomic<size_t> next(0);
+    vector<vector<int64_t>> counts(num_threads, vector<int64_t>(hands.size(), 0));
+    auto worker = [&](int id) -> void {
+        alignas(64) double res[NUM_LANES];
+        while (true) {
+            size_t begin = next.fetch_add(CHUNK);
+            if (begin >= works.size()) break;
+            size_t end = min(begin + CHUNK, works.size());
+            for (size_t i = begin; i < end; ++i) {
+                const array<int, 4>& p = works[i].second;
+                evaluate(p[0], p[1], p[2], p[3], res);
+                counts[id][works[i].first] += count_hits(res, target);
+            }
+        }
+    };
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int id = 0; id < num_threads; ++id) threads.emplace_back(worker, id);
+    for (thread& th : threads) th.join();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // スレッドごとの個数をまとめる
+    vector<int64_t> total(hands.size(), 0);
+    for (int id = 0; id < num_threads; ++id)
+        for (size_t h = 0; h < hands.size(); ++h) total[h] += counts[id][h];
+
+    // 出力 (--list が指定された場合は、手札ごとの一致した計算式の個数も出力する)
+    int solvable = 0;
+    for (size_t h = 0; h < hands.size(); ++h) {
+        if (total[h] > 0) ++solvable;
+        if (list) {
+            for (int v : hands[h]) cout << v << " ";
+            cout << ": " << total[h] << endl;
+        }
+    }
+    double num_exps = (double)works.size() * NUM_LANES;
+    cout << "target: " << target << endl;
+    cout << "hands: " << hands.size() << ", solvable: " << solvable << endl;
+    cout << "expressions: " << (int64_t)num_exps << ", threads: " << num_threads
+         << ", time: " << sec << " sec, " << num_exps / sec / 1e6
+         << " M expressions/sec" << endl;
+}
@@ -0,0 +1,311 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <map>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// 有理数を表す構造体 (分母は常に正、既約分数で保持する)
+struct Fraction {
+    int64_t num, den;  // 分子、分母
+
+    // コンストラクタ (約分してから格納する)
+    Fraction(int64_t n = 0, int64_t d = 1) {
+        if (d < 0) n = -n, d = -d;
+        int64_t a = n < 0 ? -n : n, b = d;
+        while (b != 0) {
+            int64_t r = a % b;
+            a = b, b = r;
+        }
+        if (a > 1) n /= a, d /= a;
+        num = n, den = d;
+    }
+};
+
+// 有理数の比較 (4 つの数の計算では分子、分母とも 64 ビットに収まる)
+bool operator<(const Fraction& a, const Fraction& b) {
+    return a.num * b.den < b.num * a.den;
+}
+
+// 復元した計算式 (括弧付けの判定のため、最後に適用した演算子も持つ)
+struct Expression {
+    string str;  // 計算式を表す文字列
+    char op;  // 最後に適用した演算子 (数値そのものの場合は ' ')
+};
+
+// 計算式 left と right を演算子 op で結合する
+Expression combine(const Expression& left, const Expression& right, char op) {
+    // 演算子が「*」「/」で、前の式の最後の演算が「+」「-」のとき括弧をつける
+    string first = left.str;
+    if ((op == '*' || op == '/') && (left.op == '+' || left.op == '-'))
+        first = "(" + first + ")";
+
+    // 後の式は、演算子の優先順位が同じでも「-」「/」の後ろなら括弧をつける
+    string second = right.str;
+    if (right.op == '+' || right.op == '-') {
+        if (op == '-' || op == '*' || op == '/')
+            second = "(" + second + ")";
+    } else if (right.op == '*' || right.op == '/') {
+        if (op == '/')
+            second = "(" + second + ")";
+    }
+    return Expression{first + " " + op + " " + second, op};
+}
+
+// 4 つの数 val で作れるすべての値と、それぞれを作る代表的な計算式を求める
+map<Fraction, Expression> enumerate(const vector<int>& val) {
+    // table[S]: 部分集合 S に含まれる数をすべて 1 回ずつ使って作れる値
+    int N = val.size();
+    vector<map<Fraction, Expression>> table(1 << N);
+    for (int i = 0; i < N; ++i)
+        table[1 << i][Fraction(val[i])] = Expression{to_string(val[i]), ' '};
+
+    // 部分集合 S を小さい順に処理すれば、真部分集合の値はすでに求まっている
+    for (int S = 1; S < (1 << N); ++S) {
+        if ((S & (S - 1)) == 0) continue;
+        map<Fraction, Expression>& res = table[S];
+        for (int A = (S - 1) & S; A > 0; A = (A - 1) & S) {
+            int B = S ^ A;
+            for (const auto& [a, ea] : table[A]) {
+                for (const auto& [b, eb] : table[B]) {
+                    // 先に見つかった式を代表として残す
+                    Fraction ab = Fraction(a.num * b.den + b.num * a.den,
+                                           a.den * b.den);
+                    if (!res.count(ab)) res[ab] = combine(ea, eb, '+');
+                    Fraction sub = Fraction(a.num * b.den - b.num * a.den,
+                                            a.den * b.den);
+                    if (!res.count(sub)) res[sub] = combine(ea, eb, '-');
+                    Fraction mul = Fraction(a.num * b.num, a.den * b.den);
+                    if (!res.count(mul)) res[mul] = combine(ea, eb, '*');
+                    if (b.num != 0) {
+                        Fraction div = Fraction(a.num * b.den, a.den * b.num);
+                        if (!res.count(div)) res[div] = combine(ea, eb, '/');
+                    }
+                }
+            }
+        }
+    }
+    return table[(1 << N) - 1];
+}
+
+// 二項係数 nCk
+int64_t binom(int64_t n, int64_t k) {
+    if (k < 0 || k > n) return 0;
+    int64_t res = 1;
+    for (int64_t i = 1; i <= k; ++i) res = res * (n - k + i) / i;
+    return res;
+}
+
+// 索引ファイルのヘッダ
+struct IndexHeader {
+    char magic[8];  // "TENPZIDX"
+    int32_t min_val, max_val;  // 手札に使える数の範囲
+    int32_t min_target, max_target;  // 索引に含める作りたい数の範囲
+    int64_t num_hands;  // 手札 (4 つの数の多重集合) の個数
+    int64_t pool_offset;  // 計算式の文字列を格納した領域の、ファイル先頭からの位置
+};
+
+// 索引ファイルの構成
+// ヘッダ、オフセット表 uint32_t[num_hands][max_target - min_target + 1]、
+// 計算式の文字列 ('\0' 区切り) の順に並べる
+// オフセット表の値は文字列領域の中の位置で、0 は「作れない」を表す
+const char MAGIC[8] = {'T', 'E', 'N', 'P', 'Z', 'I', 'D', 'X'};
+
+// 手札の番号を求める (4 つの数を昇順に並べて、組合せ数系で番号付けする)
+// 番号は 0 以上 nHr (n = max_val - min_val + 1, r = 4) 未満になる
+int64_t hand_rank(vector<int> hand, int min_val) {
+    sort(hand.begin(), hand.end());
+    int64_t res = 0;
+    for (int i = 0; i < 4; ++i)
+        res += binom(hand[i] - min_val + i, i + 1);
+    return res;
+}
+
+// 索引の範囲が正しいかどうかを返す (TenPuzzleIndex::open で読み込める範囲に限る)
+bool is_valid_range(int min_val, int max_val, int min_target, int max_target) {
+    return min_val <= max_val && max_val - (int64_t)min_val <= 1000
+        && min_target <= max_target;
+}
+
+// すべての手札について索引を作り、ファイル path に書き出す
+bool build(const string& path, int min_val, int max_val,
+           int min_target, int max_target) {
+    if (!is_valid_range(min_val, max_val, min_target, max_target)) return false;
+    int64_t num_targets = max_target - min_target + 1;
+    int64_t num_hands = binom(max_val - min_val + 4, 4);
+    vector<uint32_t> table(num_hands * num_targets, 0);
+    string pool(1, '\0');  // 位置 0 は「作れない」を表すために空けておく
+
+    // 同じ計算式の文字列は 1 回だけ格納する
+    map<string, uint32_t> pool_pos;
+
+    // 手札 a <= b <= c <= d を順に列挙する
+    for (int a = min_val; a <= max_val; ++a) {
+        for (int b = a; b <= max_val; ++b) {
+            for (int c = b; c <= max_val; ++c) {
+                for (int d = c; d <= max_val; ++d) {
+                    vector<int> hand = {a, b, c, d};
+                    int64_t rank = hand_rank(hand, min_val);
+
+                    // 作れる値のうち、範囲内の整数を索引に登録する
+                    for (const auto& [v, exp] : enumerate(hand)) {
+                        if (v.den != 1) continue;
+                        if (v.num < min_target || v.num > max_target) continue;
+                        auto it = pool_pos.find(exp.str);
+                        if (it == pool_pos.end()) {
+                            it = pool_pos.emplace(exp.str, pool.size()).first;
+                            pool += exp.str;
+                            pool += '\0';
+                        }
+                        table[rank * num_targets + (v.num - min_target)]
+                            = it->second;
+                    }
+                }
+            }
+        }
+    }
+
+    // ヘッダ、オフセット表、文字列領域の順に書き出す
+    IndexHeader header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.min_val = min_val, header.max_val = max_val;
+    header.min_target = min_target, header.max_target = max_target;
+    header.num_hands = num_hands;
+    header.pool_offset = sizeof(header) + table.size() * sizeof(uint32_t);
+    ofstream ofs(path, ios::binary);
+    if (!ofs) return false;
+    ofs.write((const char*)&header, sizeof(header));
+    ofs.write((const char*)table.data(), table.size() * sizeof(uint32_t));
+    ofs.write(pool.data(), pool.size());
+    cout << "hands: " << num_hands << ", targets: " << num_targets
+         << ", bytes: " << header.pool_offset + pool.size() << endl;
+    return (bool)ofs;
+}
+
+// mmap した索引ファイルに対する問い合わせを管理するクラス
+class TenPuzzleIndex {
+ private:
+    const char* data_ = nullptr;  // ファイルの先頭
+    size_t size_ = 0;  // ファイルのバイト数
+    const IndexHeader* header_ = nullptr;
+    const uint32_t* table_ = nullptr;  // オフセット表
+    const char* pool_ = nullptr;  // 計算式の文字列領域
+    size_t pool_size_ = 0;  // 計算式の文字列領域のバイト数
+
+    // ヘッダの内容がファイルの大きさと整合するかどうかを確認する
+    // (途中で切れたファイルや別形式のファイルを読んで、領域外を参照しないようにする)
+    bool is_consistent() const {
+        const IndexHeader& h = *header_;
+        if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+        if (!is_valid_range(h.min_val, h.max_val, h.min_target, h.max_target)) return false;
+        if (h.num_hands != binom((int64_t)h.max_val - h.min_val + 4, 4)) return false;
+
+        // オフセット表の直後から文字列領域が始まり、ファイルの末尾までに収まる
+        int64_t num_targets = (int64_t)h.max_target - h.min_target + 1;
+        if (num_targets > ((int64_t)size_ - (int64_t)sizeof(IndexHeader))
+                              / (int64_t)sizeof(uint32_t) / h.num_hands)
+            return false;
+        int64_t table_bytes = h.num_hands * num_targets * (int64_t)sizeof(uint32_t);
+        if (h.pool_offset != (int64_t)sizeof(IndexHeader) + table_bytes) return false;
+        if (h.pool_offset >= (int64_t)size_) return false;
+
+        // 文字列領域は「作れない」を表す空文字列で始まり、'\0' で終わる
+        return data_[h.pool_offset] == '\0' && data_[size_ - 1] == '\0';
+    }
+
+ public:
+    // 索引ファイルを開く (失敗した場合は false を返す)
+    bool open(const string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(IndexHeader)) {
+            close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        data_ = (const char*)p, size_ = st.st_size;
+        header_ = (const IndexHeader*)data_;
+        if (!is_consistent()) return false;
+        table_ = (const uint32_t*)(data_ + sizeof(IndexHeader));
+        pool_ = data_ + header_->pool_offset;
+        pool_size_ = size_ - header_->pool_offset;
+        return true;
+    }
+
+    // デストラクタ
+    ~TenPuzzleIndex() {
+        if (data_) munmap((void*)data_, size_);
+    }
+
+    // 手札 hand で target を作る計算式を返す
+    // 作れない場合は空文字列を返し、索引の範囲外の場合は false を返す
+    bool query(const vector<int>& hand, int target, string& res) const {
+        for (int v : hand)
+            if (v < header_->min_val || v > header_->max_val) return false;
+        if (target < header_->min_target || target > header_->max_target)
+            return false;
+        int64_t num_targets = header_->max_target - header_->min_target + 1;
+        int64_t rank = hand_rank(hand, header_->min_val);
+        uint32_t pos = table_[rank * num_targets + (target - header_->min_target)];
+        if (pos >= pool_size_) return false;  // 壊れた索引 (文字列領域の外を指す)
+        res = pool_ + pos;
+        return true;
+    }
+};
+
+int main(int argc, char** argv) {
+    // 索引の作成: build <索引ファイル> <最小の数> <最大の数> [<作りたい数の最小> <最大>]
+    if (argc >= 5 && string(argv[1]) == "build") {
+        int min_val = stoi(argv[3]), max_val = stoi(argv[4]);
+        int min_target = argc >= 7 ? stoi(argv[5]) : 0;
+        int max_target = argc >= 7 ? stoi(argv[6]) : 1000;
+        if (!is_valid_range(min_val, max_val, min_target, max_target)) {
+            cerr << "invalid range: need <min value> <= <max value> (at most 1000 apart) "
+                 << "and <min target> <= <max target>" << endl;
+            return 1;
+        }
+        if (!build(argv[2], min_val, max_val, min_target, max_target)) {
+            cerr << "failed to write " << argv[2] << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // 問い合わせ: query <索引ファイル>
+    // 標準入力から「4 つの数と作りたい数」を 1 行ずつ読み込んで答える
+    if (argc >= 3 && string(argv[1]) == "query") {
+        TenPuzzleIndex index;
+        if (!index.open(argv[2])) {
+            cerr << "failed to open " << argv[2] << endl;
+            return 1;
+        }
+        vector<int> hand(4);
+        int target;
+        while (cin >> hand[0] >> hand[1] >> hand[2] >> hand[3] >> target) {
+            string exp;
+            if (!index.query(hand, target, exp))
+                cout << "out of range" << endl;
+            else if (exp.empty())
+                cout << "No solutions." << endl;
+            else
+                cout << exp << " = " << target << endl;
+        }
+        return 0;
+    }
+
+    cerr << "usage: " << argv[0]
+         << " build <index> <min value> <max value> [<min target> <max target>]"
+         << endl << "       " << argv[0] << " query <index>" << endl;
+    return 1;
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <set>
 #include <utility>
 using namespace std;
 
@@ -91,18 +92,92 @@ string decode_poland(const string& exp) {
     return space.back();
 }
 
+// 可換律・結合律で移り合う計算式を同一視するための標準形
+// 和の節点は足す項 (pos) と引く項 (neg)、積の節点は掛ける因子 (pos) と
+// 割る因子 (neg) を、それぞれ昇順に並べて保持する
+struct Canonical {
+    int type;  // 0: 数値、1: 和、2: 積
+    int val;  // 数値の場合の値
+    vector<Canonical> pos, neg;
+};
+
+// 標準形の大小比較 (set で重複を判定するため)
+bool operator<(const Canonical& a, const Canonical& b) {
+    if (a.type != b.type) return a.type < b.type;
+    if (a.val != b.val) return a.val < b.val;
+    if (a.pos != b.pos) return a.pos < b.pos;
+    return a.neg < b.neg;
+}
+bool operator==(const Canonical& a, const Canonical& b) {
+    return !(a < b) && !(b < a);
+}
+bool operator!=(const Canonical& a, const Canonical& b) {
+    return !(a == b);
+}
+
+// 標準形 c を、種類 type の節点の項として pos または neg に加える
+// c 自身が同じ種類の節点の場合は、その項を展開して加える (結合律)
+void append_term(const Canonical& c, int type, bool inverse,
+                 vector<Canonical>& pos, vector<Canonical>& neg) {
+    if (c.type == type) {
+        for (const Canonical& t : c.pos) (inverse ? neg : pos).push_back(t);
+        for (const Canonical& t : c.neg) (inverse ? pos : neg).push_back(t);
+    } else {
+        (inverse ? neg : pos).push_back(c);
+    }
+}
+
+// 逆ポーランド記法の計算式から標準形を求める
+Canonical canonicalize(const string& exp) {
+    // 標準形を求めるための配列
+    vector<Canonical> space;
+
+    // 逆ポーランド記法 exp の各文字 c を順に見る
+    for (char c : exp) {
+        if (c >= '0' && c <= '9') {
+            // c が数字を表す文字の場合、数値の節点を配列の末尾に挿入する
+            space.push_back(Canonical{0, c - '0', {}, {}});
+        } else {
+            // c が演算子の場合、末尾から 2 つの標準形を取り出す
+            Canonical second = space.back();
+            space.pop_back();
+            Canonical first = space.back();
+            space.pop_back();
+
+            // 「+」「-」は和の節点に、「*」「/」は積の節点にまとめる
+            int type = (c == '+' || c == '-') ? 1 : 2;
+            Canonical res{type, 0, {}, {}};
+            append_term(first, type, false, res.pos, res.neg);
+            append_term(second, type, c == '-' || c == '/', res.pos, res.neg);
+
+            // 項の順序を揃える (可換律)
+            sort(res.pos.begin(), res.pos.end());
+            sort(res.neg.begin(), res.neg.end());
+            space.push_back(res);
+        }
+    }
+    return space.back();
+}
+
 // テンパズルソルバー
 // val: 4 つの数を格納した配列、target: 作りたい数
 vector<string> solve(vector<int> val, int target) {
     // 答えを表す計算式を格納する配列
     vector<string> res;
 
+    // 見つかった計算式の標準形の集合と、標準形が新しかった計算式 (逆ポーランド記法)
+    set<Canonical> seen;
+    vector<string> found;
+
     // 逆ポーランド記法の計算式 exp を試すための関数オブジェクト
     const double EPS = 1e-9;  // 十分小さい値
     auto check = [&](const string& exp) -> void {
         // 計算結果と作りたい数との差が十分小さいとき、一致とみなす
-        if (abs(calc_poland(exp) - target) < EPS)
-            res.push_back(decode_poland(exp));
+        // 可換律・結合律で既出の式と同一視できる場合は採用しない
+        if (abs(calc_poland(exp) - target) < EPS) {
+            if (seen.insert(canonicalize(exp)).second)
+                found.push_back(exp);
+        }
     };
 
     // 4 つの数 val の並び替えを順に試していく
@@ -138,6 +213,10 @@ vector<string> solve(vector<int> val, int target) {
             }
         }
     } while (next_permutation(val.begin(), val.end()));
+
+    // 重複を除いた計算式だけを通常の計算式に復元する
+    for (const string& exp : found)
+        res.push_back(decode_poland(exp));
     return res;
 }
 
@@ -0,0 +1,327 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+using namespace std;
+
+// 128 ビット整数の最大公約数
+__int128 gcd128(__int128 a, __int128 b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    while (b != 0) {
+        __int128 r = a % b;
+        a = b, b = r;
+    }
+    return a;
+}
+
+// 有理数を表す構造体 (分母は常に正、既約分数で保持する)
+struct Fraction {
+    int64_t num, den;  // 分子、分母
+
+    // コンストラクタ (途中計算は 128 ビットで行い、約分してから格納する)
+    Fraction(__int128 n = 0, __int128 d = 1) {
+        if (d < 0) n = -n, d = -d;
+        __int128 g = gcd128(n, d);
+        if (g > 1) n /= g, d /= g;
+        num = (int64_t)n, den = (int64_t)d;
+    }
+};
+
+// 有理数の比較
+bool operator==(const Fraction& a, const Fraction& b) {
+    return a.num == b.num && a.den == b.den;
+}
+bool operator<(const Fraction& a, const Fraction& b) {
+    return (__int128)a.num * b.den < (__int128)b.num * a.den;
+}
+
+// 有理数の四則演算 (割り算は b が 0 でないことを呼び出し側で保証する)
+Fraction operator+(const Fraction& a, const Fraction& b) {
+    return Fraction((__int128)a.num * b.den + (__int128)b.num * a.den,
+                    (__int128)a.den * b.den);
+}
+Fraction operator-(const Fraction& a, const Fraction& b) {
+    return Fraction((__int128)a.num * b.den - (__int128)b.num * a.den,
+                    (__int128)a.den * b.den);
+}
+Fraction operator*(const Fraction& a, const Fraction& b) {
+    return Fraction((__int128)a.num * b.num, (__int128)a.den * b.den);
+}
+Fraction operator/(const Fraction& a, const Fraction& b) {
+    return Fraction((__int128)a.num * b.den, (__int128)a.den * b.num);
+}
+
+// 復元した計算式 (括弧付けの判定のため、最後に適用した演算子も持つ)
+struct Expression {
+    string str;  // 計算式を表す文字列
+    char op;  // 最後に適用した演算子 (数値そのものの場合は ' ')
+};
+
+// 計算式 left と right を演算子 op で結合する
+Expression combine(const Expression& left, const Expression& right, char op) {
+    // 演算子が「*」「/」で、前の式の最後の演算が「+」「-」のとき括弧をつける
+    string first = left.str;
+    if ((op == '*' || op == '/') && (left.op == '+' || left.op == '-'))
+        first = "(" + first + ")";
+
+    // 後の式は、演算子の優先順位が同じでも「-」「/」の後ろなら括弧をつける
+    string second = right.str;
+    if (right.op == '+' || right.op == '-') {
+        if (op == '-' || op == '*' || op == '/')
+            second = "(" + second + ")";
+    } else if (right.op == '*' || right.op == '/') {
+        if (op == '/')
+            second = "(" + second + ")";
+    }
+    return Expression{first + " " + op + " " + second, op};
+}
+
+// 部分集合 S と値 v の組をキーとするハッシュ
+struct StateHash {
+    size_t operator()(const pair<int, Fraction>& key) const {
+        uint64_t h = key.first;
+        h = h * 0x9E3779B97F4A7C15ULL + (uint64_t)key.second.num;
+        h = h * 0x9E3779B97F4A7C15ULL + (uint64_t)key.second.den;
+        return h ^ (h >> 29);
+    }
+};
+
+// 部分集合ごとの到達可能値を用いて、N 個の数のテンパズルを解くクラス
+class SubsetTenPuzzle {
+ private:
+    // 入力された N 個の数
+    vector<int> val_;
+
+    // 到達可能値を配列として作っておく部分集合の要素数の上限
+    int max_size_;
+
+    // values_[S]: 部分集合 S に含まれる数をすべて 1 回ずつ使って作れる値
+    // (昇順に並べて重複を除いたもの、必要になったときに作る)
+    vector<vector<Fraction>> values_;
+    vector<bool> built_;
+
+    // 要素数が max_size_ を超える部分集合について、値が作れるかどうかのメモ
+    unordered_map<pair<int, Fraction>, bool, StateHash> can_make_memo_;
+
+    // 部分集合 S で値 v を作る計算式のメモ
+    map<pair<int, Fraction>, vector<Expression>> memo_;
+
+    // 部分集合 S で作れる値をすべて求める
+    const vector<Fraction>& values(int S);
+
+    // 部分集合 S で値 v が作れるかどうか
+    bool can_make(int S, const Fraction& v);
+
+    // 部分集合 S の分割 X, Y = S - X のうち、X の側の値を列挙するものを順に処理する
+    // (X の要素数を Y 以下とすることで、列挙する値の個数を抑える)
+    template <class Func> void for_each_split(int S, const Func& func);
+
+    // 部分集合 S で値 v を作る計算式を、最大 max_num 個まで復元する
+    const vector<Expression>& rebuild(int S, const Fraction& v, int max_num);
+
+ public:
+    // コンストラクタ
+    SubsetTenPuzzle(const vector<int>& val);
+
+    // 作りたい数 target を作る計算式を、最大 max_num 個まで求める
+    vector<string> solve(int target, int max_num);
+};
+
+SubsetTenPuzzle::SubsetTenPuzzle(const vector<int>& val)
+    : val_(val), max_size_(val.size() / 2 + 1),
+      values_(1 << val.size()), built_(1 << val.size(), false) {
+}
+
+template <class Func> void SubsetTenPuzzle::for_each_split(int S, const Func& func) {
+    int low = S & -S;
+    int size = __builtin_popcount(S);
+    for (int X = (S - 1) & S; X > 0; X = (X - 1) & S) {
+        // 要素数が半分ずつのときは、X が最下位要素を含む方だけを採用する
+        int x_size = __builtin_popcount(X);
+        if (x_size * 2 > size) continue;
+        if (x_size * 2 == size && !(X & low)) continue;
+        func(X, S ^ X);
+    }
+}
+
+const vector<Fraction>& SubsetTenPuzzle::values(int S) {
+    vector<Fraction>& res = values_[S];
+    if (built_[S]) return res;
+    built_[S] = true;
+
+    // 要素が 1 個の場合は、その数自身
+    if ((S & (S - 1)) == 0) {
+        res.push_back(Fraction(val_[__builtin_ctz(S)]));
+        return res;
+    }
+
+    // S を X と Y に分けて、両者の値の四則演算の結果をすべて求める
+    for_each_split(S, [&](int X, int Y) {
+        const vector<Fraction>& xs = values(X);
+        const vector<Fraction>& ys = values(Y);
+        for (const Fraction& x : xs) {
+            for (const Fraction& y : ys) {
+                res.push_back(x + y);
+                res.push_back(x - y);
+                res.push_back(y - x);
+                res.push_back(x * y);
+                if (y.num != 0) res.push_back(x / y);
+                if (x.num != 0) res.push_back(y / x);
+            }
+        }
+    });
+
+    // 昇順に並べて重複を除く
+    sort(res.begin(), res.end());
+    res.erase(unique(res.begin(), res.end()), res.end());
+    return res;
+}
+
+bool SubsetTenPuzzle::can_make(int S, const Fraction& v) {
+    // 要素数が小さい部分集合は、作れる値をすべて求めておいて二分探索する
+    if (__builtin_popcount(S) <= max_size_ || built_[S]) {
+        const vector<Fraction>& vs = values(S);
+        return binary_search(vs.begin(), vs.end(), v);
+    }
+
+    // メモ済みの場合はそれを返す
+    auto key = make_pair(S, v);
+    auto it = can_make_memo_.find(key);
+    if (it != can_make_memo_.end()) return it->second;
+
+    // 要素数の小さい側 X の値 x を列挙し、Y で作るべき値が作れるかを調べる
+    bool res = false;
+    for_each_split(S, [&](int X, int Y) {
+        if (res) return;
+        for (const Fraction& x : values(X)) {
+            if (can_make(Y, v - x) || can_make(Y, x - v) || can_make(Y, v + x)
+                || (x.num != 0 && (can_make(Y, v / x) || can_make(Y, v * x)))
+                || (v.num != 0 && x.num != 0 && can_make(Y, x / v))) {
+                res = true;
+                return;
+            }
+
+            // x = 0, v = 0 のときは、x * y = 0 が任意の y について成り立つ
+            if (x.num == 0 && v.num == 0) {
+                res = true;
+                return;
+            }
+        }
+    });
+    return can_make_memo_[key] = res;
+}
+
+const vector<Expression>&
+SubsetTenPuzzle::rebuild(int S, const Fraction& v, int max_num) {
+    // メモ済みの場合はそれを返す
+    auto key = make_pair(S, v);
+    auto it = memo_.find(key);
+    if (it != memo_.end()) return it->second;
+    vector<Expression> res;
+    set<string> seen;  // 同じ数が複数ある場合に生じる、同一の式を除くため
+
+    // 要素が 1 個の場合は、その数自身
+    if ((S & (S - 1)) == 0) {
+        int x = val_[__builtin_ctz(S)];
+        if (Fraction(x) == v) res.push_back(Expression{to_string(x), ' '});
+        return memo_[key] = res;
+    }
+
+    // 前の式 (集合 A で値 a) と後の式 (集合 B で値 b) を演算子 op で結合する
+    auto add = [&](int A, const Fraction& a, int B, const Fraction& b,
+                   char op) -> void {
+        if ((int)res.size() >= max_num) return;
+        if (!can_make(A, a) || !can_make(B, b)) return;
+        const vector<Expression>& left = rebuild(A, a, max_num);
+        const vector<Expression>& right = rebuild(B, b, max_num);
+        for (const Expression& l : left) {
+            for (const Expression& r : right) {
+                if ((int)res.size() >= max_num) return;
+                Expression exp = combine(l, r, op);
+                if (seen.insert(exp.str).second) res.push_back(exp);
+            }
+        }
+    };
+
+    // 要素数の小さい側 X の値 x を列挙し、x op y = v または y op x = v となる y を探す
+    // (足し算と掛け算は可換なので、最下位要素を含む側を前に置く 1 通りのみ試す)
+    int low = S & -S;
+    for_each_split(S, [&](int X, int Y) {
+        for (const Fraction& x : values(X)) {
+            // 足し算
+            if (X & low) add(X, x, Y, v - x, '+');
+            else add(Y, v - x, X, x, '+');
+
+            // 引き算
+            add(X, x, Y, x - v, '-');
+            add(Y, v + x, X, x, '-');
+
+            // 掛け算
+            if (x.num != 0) {
+                if (X & low) add(X, x, Y, v / x, '*');
+                else add(Y, v / x, X, x, '*');
+            } else if (v.num == 0) {
+                // 0 * y = 0 はすべての y について成り立つ
+                for (const Fraction& y : values(Y)) {
+                    if (X & low) add(X, x, Y, y, '*');
+                    else add(Y, y, X, x, '*');
+                }
+            }
+
+            // 割り算
+            if (x.num != 0) {
+                add(Y, v * x, X, x, '/');
+                if (v.num != 0) add(X, x, Y, x / v, '/');
+            } else if (v.num == 0) {
+                // 0 / y = 0 はすべての 0 でない y について成り立つ
+                for (const Fraction& y : values(Y))
+                    if (y.num != 0) add(X, x, Y, y, '/');
+            }
+        }
+    });
+    return memo_[key] = res;
+}
+
+vector<string> SubsetTenPuzzle::solve(int target, int max_num) {
+    // 全体集合で target を作る計算式だけを復元する
+    int full = (1 << val_.size()) - 1;
+    vector<string> res;
+    for (const Expression& exp : rebuild(full, Fraction(target), max_num))
+        res.push_back(exp.str);
+    return res;
+}
+
+int main() {
+    // 数の個数、各数、作りたい数の入力
+    int N;  // 数の個数
+    cout << "the number of numbers: ";
+    cin >> N;
+    vector<int> val(N);
+    for (int i = 0; i < N; ++i) {
+        cout << i + 1 << " th number: ";
+        cin >> val[i];
+    }
+    int target;  // 作りたい数
+    cout << "target number: ";
+    cin >> target;
+
+    // テンパズルを解く (出力する式は最大 MAX_NUM 個とする)
+    const int MAX_NUM = 1000;
+    SubsetTenPuzzle tp(val);
+    const vector<string>& res = tp.solve(target, MAX_NUM);
+
+    // 出力 (MAX_NUM 個で打ち切った場合は、それ以上ある可能性がある)
+    if ((int)res.size() >= MAX_NUM) {
+        cout << "The number of solutions: " << MAX_NUM << " or more (showing the first "
+             << MAX_NUM << ")" << endl;
+    } else {
+        cout << "The number of solutions: " << res.size() << endl;
+    }
+    for (const string& exp : res)
+        cout << exp << " = " << target << endl;
+}
@@ -0,0 +1,307 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <utility>
+#include <chrono>
+using namespace std;
+
+// 演算子の種類
+const int EMPTY = 0;
+const int PLUS = 1;
+const int MINUS = 2;
+const int MUL = 3;
+const int DIV = 4;
+
+// 128 ビット整数の最大公約数
+// 64 ビットに収まる場合は、割り算を使わない二進 GCD で高速に求める
+__int128 gcd128(__int128 a, __int128 b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    if (a <= INT64_MAX && b <= INT64_MAX) {
+        uint64_t x = (uint64_t)a, y = (uint64_t)b;
+        if (x == 0 || y == 0) return x | y;
+        int shift = __builtin_ctzll(x | y);
+        x >>= __builtin_ctzll(x);
+        while (y != 0) {
+            y >>= __builtin_ctzll(y);
+            if (x > y) swap(x, y);
+            y -= x;
+        }
+        return x << shift;
+    }
+    while (b != 0) {
+        __int128 r = a % b;
+        a = b, b = r;
+    }
+    return a;
+}
+
+// 有理数を表す構造体 (分母は常に正、既約分数で保持する)
+// 長い数字列でも連結した数が収まるように、128 ビット整数で保持する
+struct Fraction {
+    __int128 num, den;  // 分子、分母
+
+    // コンストラクタ (約分してから格納する)
+    Fraction(__int128 n = 0, __int128 d = 1) {
+        if (d < 0) n = -n, d = -d;
+        if (d != 1) {
+            __int128 g = gcd128(n, d);
+            if (g > 1) n /= g, d /= g;
+        }
+        num = n, den = d;
+    }
+};
+
+// 有理数の比較と足し算
+bool operator==(const Fraction& a, const Fraction& b) {
+    return a.num == b.num && a.den == b.den;
+}
+Fraction operator+(const Fraction& a, const Fraction& b) {
+    if (a.den == 1 && b.den == 1) return Fraction(a.num + b.num);
+    return Fraction(a.num * b.den + b.num * a.den, a.den * b.den);
+}
+
+// 項 term に数値 val を掛ける、または割る (op は MUL か DIV)
+Fraction apply(const Fraction& term, int op, __int128 val) {
+    if (op == MUL) return Fraction(term.num * val, term.den);
+    else return Fraction(term.num, term.den * val);
+}
+
+// 有理数をキーとするハッシュ
+struct FractionHash {
+    size_t operator()(const Fraction& f) const {
+        uint64_t h = (uint64_t)f.num ^ (uint64_t)(f.num >> 64);
+        h = h * 0x9E3779B97F4A7C15ULL + ((uint64_t)f.den ^ (uint64_t)(f.den >> 64));
+        return h ^ (h >> 31);
+    }
+};
+
+// 値ごとの個数 (個数は 5^(数字の個数 - 1) 未満なので 128 ビットで足りる)
+using Counter = unordered_map<Fraction, __int128, FractionHash>;
+
+// 計算途中の項 (1_2_komachi_solver.cpp の rec の term, op, cur と同じ表し方)
+//   term: 確定した部分、op: term と cur の間の演算子、cur: 連結中の数値
+struct TermState {
+    Fraction term;
+    int op;
+    __int128 cur;
+};
+bool operator==(const TermState& a, const TermState& b) {
+    return a.term == b.term && a.op == b.op && a.cur == b.cur;
+}
+struct TermStateHash {
+    size_t operator()(const TermState& st) const {
+        return FractionHash()(st.term) * 31 + (uint64_t)st.cur * 5 + st.op;
+    }
+};
+
+// 128 ビット整数を文字列に変換する
+string to_string128(__int128 v) {
+    if (v == 0) return "0";
+    string res;
+    bool minus = v < 0;
+    if (minus) v = -v;
+    while (v > 0) res += char('0' + v % 10), v /= 10;
+    if (minus) res += '-';
+    return string(res.rbegin(), res.rend());
+}
+
+// 小町算の解の個数を、動的計画法と半分全列挙で数えるクラス
+// 1_2_komachi_solver.cpp の rec は途中経過 (sum, term, op, cur) を持ち回るが、
+// + と - で区切られた項の中身 (term, op, cur) と、確定した和 sum は独立に決まる
+// そこで次のように分けて、等しい途中経過をひとまとめにして個数だけを数える
+//   1. 数字 i 番目から j 番目までを 1 つの項とするときの、項の値ごとの入れ方の個数
+//   2. 中央の数字 mid_ 番目を含む項を [i, j] とすると、計算式は
+//      「数字 i 番目より前の項の和」±「項 [i, j]」+「数字 j 番目より後の項の和」
+//      と分けられるので、前後の和ごとの個数をそれぞれ求めて突き合わせる
+// 前後の和はそれぞれ数字列の半分程度しか見ないので、和の種類数が爆発しない
+class KomachiCounter {
+ private:
+    // 並べる数字と作りたい数
+    string digits_;
+    Fraction target_;
+
+    // 中央の数字の位置 (この数字を含む項で計算式を前後に分ける)
+    int mid_;
+
+    // terms_[i][j - i]: 数字 i 番目から j 番目までを 1 つの項とするときの、
+    // 項の値 (符号は含まない) ごとの入れ方の個数
+    vector<vector<Counter>> terms_;
+
+    // 保持した和の種類数の合計
+    size_t num_states_ = 0;
+
+    // terms_ を求める
+    void build_terms();
+
+ public:
+    // コンストラクタ
+    KomachiCounter(const string& digits, int64_t target)
+        : digits_(digits), target_(Fraction(target)) {
+        mid_ = ((int)digits_.size() - 1) / 2;
+    }
+
+    // 解の個数を数える
+    __int128 count();
+
+    // 保持した途中経過の種類数
+    size_t num_states() const { return num_states_; }
+};
+
+void KomachiCounter::build_terms() {
+    int n = digits_.size();
+    terms_.assign(n, vector<Counter>());
+    for (int i = 0; i < n; ++i) {
+        terms_[i].resize(n - i);
+
+        // 項の途中経過 (term, op, cur) ごとの個数を左から順に更新する
+        using Layer = unordered_map<TermState, __int128, TermStateHash>;
+        Layer cur_layer, next_layer;
+        cur_layer[TermState{Fraction(1), MUL, digits_[i] - '0'}] = 1;
+        for (int j = i; j < n; ++j) {
+            // 数字 j 番目で項を閉じる (0 で割る場合は除外する)
+            for (const auto& [st, num] : cur_layer) {
+                if (st.op == DIV && st.cur == 0) continue;
+                terms_[i][j - i][apply(st.term, st.op, st.cur)] += num;
+            }
+            if (j + 1 == n) break;
+
+            // □ j に空白、掛け算、割り算を入れて項を続ける
+            __int128 add = digits_[j + 1] - '0';
+            next_layer.clear();
+            next_layer.reserve(cur_layer.size() * 3);
+            for (const auto& [st, num] : cur_layer) {
+                next_layer[TermState{st.term, st.op, st.cur * 10 + add}] += num;
+                if (st.op == DIV && st.cur == 0) continue;
+                Fraction closed = apply(st.term, st.op, st.cur);
+                next_layer[TermState{closed, MUL, add}] += num;
+                next_layer[TermState{closed, DIV, add}] += num;
+            }
+            swap(cur_layer, next_layer);
+        }
+    }
+}
+
+__int128 KomachiCounter::count() {
+    build_terms();
+    int n = digits_.size();
+
+    // 符号 sign をつけた項の値
+    auto signed_term = [](const Fraction& t, int sign) -> Fraction {
+        return sign == 1 ? t : Fraction(-t.num, t.den);
+    };
+
+    // left[i]: 数字 i 番目 (i <= mid_) より前をいくつかの項に区切ったときの、和ごとの個数
+    // (最初の項の符号は + のみ)
+    vector<Counter> left(mid_ + 1);
+    left[0][Fraction(0)] = 1;
+    for (int i = 0; i < mid_; ++i) {
+        for (int sign : {1, -1}) {
+            if (i == 0 && sign == -1) continue;
+            for (const auto& [sum, num] : left[i])
+                for (int j = i; j < mid_; ++j)
+                    for (const auto& [t, cnt] : terms_[i][j - i])
+                        left[j + 1][sum + signed_term(t, sign)] += num * cnt;
+        }
+    }
+
+    // right[k]: 数字 k 番目 (k > mid_) 以降をいくつかの項に区切ったときの、和ごとの個数
+    // (どの項にも + と - の符号がつく、right[n] は空の和)
+    vector<Counter> right(n + 1);
+    right[n][Fraction(0)] = 1;
+    for (int k = n - 1; k > mid_; --k) {
+        for (int sign : {1, -1})
+            for (int j = k; j < n; ++j)
+                for (const auto& [t, cnt] : terms_[k][j - k])
+                    for (const auto& [sum, num] : right[j + 1])
+                        right[k][signed_term(t, sign) + sum] += cnt * num;
+    }
+    num_states_ = 0;
+    for (const Counter& c : left) num_states_ += c.size();
+    for (const Counter& c : right) num_states_ += c.size();
+
+    // 中央の数字を含む項 [i, j] ごとに、前の和 + 符号つきの項 + 後の和 = 作りたい数
+    // となる組を数える (前後のうち種類数の少ない方を列挙し、もう一方を引く)
+    __int128 res = 0;
+    for (int i = 0; i <= mid_; ++i) {
+        for (int j = mid_; j < n; ++j) {
+            const Counter& before = left[i];
+            const Counter& after = right[j + 1];
+            for (int sign : {1, -1}) {
+                if (i == 0 && sign == -1) continue;
+                for (const auto& [t, cnt] : terms_[i][j - i]) {
+                    // rest = 作りたい数 - 符号つきの項 = 前の和 + 後の和
+                    Fraction rest = target_ + signed_term(t, -sign);
+                    const Counter& small = before.size() <= after.size() ? before : after;
+                    const Counter& large = before.size() <= after.size() ? after : before;
+                    for (const auto& [v, num] : small) {
+                        auto it = large.find(rest + Fraction(-v.num, v.den));
+                        if (it != large.end()) res += cnt * num * it->second;
+                    }
+                }
+            }
+        }
+    }
+    return res;
+}
+
+// 比較用: 1_2_komachi_solver.cpp の rec と同じ全探索で解の個数を数える
+void rec_count(const string& digits, const Fraction& target, int pos,
+               const Fraction& sum, const Fraction& term, int op, __int128 cur,
+               int64_t& res) {
+    // 終端条件: すべての □ に演算子を入れた
+    if (pos + 1 == (int)digits.size()) {
+        if (op == DIV && cur == 0) return;
+        __int128 n = term.num, d = term.den;
+        if (op == MUL) n *= cur;
+        else d *= cur;
+        if (sum.num * d + n * sum.den == target.num * sum.den * d) ++res;
+        return;
+    }
+    __int128 add = digits[pos + 1] - '0';
+
+    // 空白の場合は数値を連結する
+    rec_count(digits, target, pos + 1, sum, term, op, cur * 10 + add, res);
+
+    // 以降の演算子を入れると cur が確定する (0 で割る場合は除外する)
+    if (op == DIV && cur == 0) return;
+    Fraction closed = apply(term, op, cur);
+    Fraction new_sum = sum + closed;
+    rec_count(digits, target, pos + 1, new_sum, Fraction(1), MUL, add, res);
+    rec_count(digits, target, pos + 1, new_sum, Fraction(-1), MUL, add, res);
+    rec_count(digits, target, pos + 1, sum, closed, MUL, add, res);
+    rec_count(digits, target, pos + 1, sum, closed, DIV, add, res);
+}
+
+int main(int argc, char** argv) {
+    // 使い方: komachi_counter_by_dp [digits] [target] [--compare]
+    //   並べる数字と作りたい数 (省略時は 123456789 と 100)
+    //   --compare を指定した場合は、全探索 (rec) でも数えて時間を比較する
+    string digits = argc >= 2 ? argv[1] : "123456789";
+    int64_t target = argc >= 3 ? stoll(argv[2]) : 100;
+    bool compare = argc >= 4 && string(argv[3]) == "--compare";
+
+    // 動的計画法と半分全列挙で解の個数を数える
+    auto start = chrono::steady_clock::now();
+    KomachiCounter counter(digits, target);
+    __int128 num = counter.count();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 答えを出力する
+    cout << "The number of solutions: " << to_string128(num) << endl;
+    cout << "The number of states: " << counter.num_states() << endl;
+    if (!compare) return 0;
+
+    // 全探索で数え直して、結果と時間を比較する
+    start = chrono::steady_clock::now();
+    int64_t num_rec = 0;
+    rec_count(digits, Fraction(target), 0, Fraction(0), Fraction(1), MUL,
+              digits[0] - '0', num_rec);
+    double sec_rec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "rec: " << num_rec << " solutions, " << sec_rec << " sec" << endl;
+    cout << "counter: " << to_string128(num) << " solutions, " << sec << " sec" << endl;
+    cout << (num == num_rec ? "match" : "MISMATCH") << endl;
+}
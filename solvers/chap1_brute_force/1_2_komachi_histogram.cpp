@@ -0,0 +1,255 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <utility>
+using namespace std;
+
+// 演算子の種類
+const int EMPTY = 0;
+const int PLUS = 1;
+const int MINUS = 2;
+const int MUL = 3;
+const int DIV = 4;
+
+// 128 ビット整数の最大公約数
+// 64 ビットに収まる場合は、割り算を使わない二進 GCD で高速に求める
+__int128 gcd128(__int128 a, __int128 b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    if (a <= INT64_MAX && b <= INT64_MAX) {
+        uint64_t x = (uint64_t)a, y = (uint64_t)b;
+        if (x == 0 || y == 0) return x | y;
+        int shift = __builtin_ctzll(x | y);
+        x >>= __builtin_ctzll(x);
+        while (y != 0) {
+            y >>= __builtin_ctzll(y);
+            if (x > y) swap(x, y);
+            y -= x;
+        }
+        return x << shift;
+    }
+    while (b != 0) {
+        __int128 r = a % b;
+        a = b, b = r;
+    }
+    return a;
+}
+
+// 有理数を表す構造体 (分母は常に正、既約分数で保持する)
+struct Fraction {
+    int64_t num, den;  // 分子、分母
+
+    // コンストラクタ (途中計算は 128 ビットで行い、約分してから格納する)
+    Fraction(__int128 n = 0, __int128 d = 1) {
+        // 整数の場合は約分を省略する
+        if (d == 1) {
+            num = (int64_t)n, den = 1;
+            return;
+        }
+        if (d < 0) n = -n, d = -d;
+        __int128 g = gcd128(n, d);
+        if (g > 1) n /= g, d /= g;
+        num = (int64_t)n, den = (int64_t)d;
+    }
+};
+
+// 有理数の比較と足し算
+bool operator==(const Fraction& a, const Fraction& b) {
+    return a.num == b.num && a.den == b.den;
+}
+bool operator<(const Fraction& a, const Fraction& b) {
+    return (__int128)a.num * b.den < (__int128)b.num * a.den;
+}
+Fraction operator+(const Fraction& a, const Fraction& b) {
+    if (a.den == 1 && b.den == 1) return Fraction(a.num + b.num);
+    return Fraction((__int128)a.num * b.den + (__int128)b.num * a.den,
+                    (__int128)a.den * b.den);
+}
+
+// 有理数をキーとするハッシュ
+struct FractionHash {
+    size_t operator()(const Fraction& f) const {
+        uint64_t h = (uint64_t)f.num * 0x9E3779B97F4A7C15ULL + (uint64_t)f.den;
+        return h ^ (h >> 31);
+    }
+};
+
+// 項 term に数値 val を掛ける、または割る (op は MUL か DIV)
+Fraction apply(const Fraction& term, int op, int64_t val) {
+    if (op == MUL) return Fraction((__int128)term.num * val, term.den);
+    else return Fraction(term.num, (__int128)term.den * val);
+}
+
+// 値ごとの解の個数と、解の 1 つ (演算子の入れ方を 5 進数で符号化したもの)
+struct Entry {
+    int64_t count = 0;
+    uint64_t witness = UINT64_MAX;
+};
+using Histogram = unordered_map<Fraction, Entry, FractionHash>;
+
+// 計算式の途中経過 (1_2_komachi_solver.cpp の rec と同じ表し方)
+//   sum: 確定した項の和、term: 計算途中の項の確定した部分 (符号を含む)
+//   op: term と cur の間の演算子、cur: 連結中の数値、code: 入れた演算子の符号
+struct State {
+    Fraction sum, term;
+    int op;
+    int64_t cur;
+    uint64_t code;
+};
+
+// 演算子を 1 つ入れたあとの途中経過を求める (0 で割る場合は false を返す)
+bool step(const State& st, int sign, int64_t add, State& res) {
+    if (sign == EMPTY) {
+        res = State{st.sum, st.term, st.op, st.cur * 10 + add, st.code * 5 + sign};
+        return true;
+    }
+    if (st.op == DIV && st.cur == 0) return false;
+    Fraction closed = apply(st.term, st.op, st.cur);
+    if (sign == MUL || sign == DIV)
+        res = State{st.sum, closed, sign, add, st.code * 5 + sign};
+    else
+        res = State{st.sum + closed, Fraction(sign == PLUS ? 1 : -1), MUL, add,
+                    st.code * 5 + sign};
+    return true;
+}
+
+// 小町算のすべての値についての解の個数を求めるクラス
+class KomachiHistogram {
+ private:
+    // 並べる数字
+    string digits_;
+
+    // 再帰関数: □ pos 以降に演算子を入れて、値ごとの解の個数を hist に加える
+    void rec(int pos, const State& st, Histogram& hist) const;
+
+ public:
+    // コンストラクタ
+    KomachiHistogram(const string& digits) : digits_(digits) { }
+
+    // 先頭の □ 数個の演算子の入れ方をタスクとしてスレッドに分配し、
+    // スレッドごとのヒストグラムを最後にまとめる
+    Histogram solve(int num_threads) const;
+
+    // 5 進数で符号化した演算子の入れ方から、計算式を復元する
+    string decode(uint64_t code) const;
+};
+
+void KomachiHistogram::rec(int pos, const State& st, Histogram& hist) const {
+    // 終端条件: すべての □ に演算子を入れた
+    if (pos == (int)digits_.size() - 1) {
+        if (st.op == DIV && st.cur == 0) return;
+        Entry& e = hist[st.sum + apply(st.term, st.op, st.cur)];
+        ++e.count;
+        e.witness = min(e.witness, st.code);
+        return;
+    }
+
+    // □ pos に 5 種類の演算子を順に入れる
+    int64_t add = digits_[pos + 1] - '0';
+    State next;
+    for (int sign = 0; sign < 5; ++sign) {
+        if (step(st, sign, add, next)) rec(pos + 1, next, hist);
+    }
+}
+
+Histogram KomachiHistogram::solve(int num_threads) const {
+    // 先頭の depth 個の □ の演算子の入れ方 (5^depth 通り) をタスクとする
+    int n = digits_.size();
+    int depth = 0;
+    int64_t num_tasks = 1;
+    while (depth < n - 1 && num_tasks < 64 * num_threads) ++depth, num_tasks *= 5;
+
+    // 各スレッドは未処理のタスクを順に取り出して処理する
+    atomic<int64_t> next_task(0);
+    vector<Histogram> hists(num_threads);
+    auto worker = [&](int id) -> void {
+        while (true) {
+            int64_t task = next_task.fetch_add(1);
+            if (task >= num_tasks) break;
+
+            // タスク番号を 5 進数とみて、先頭の □ の演算子を入れる
+            State st{Fraction(0), Fraction(1), MUL, digits_[0] - '0', 0};
+            bool valid = true;
+            int64_t order = num_tasks;
+            for (int pos = 0; pos < depth && valid; ++pos) {
+                order /= 5;
+                int sign = task / order % 5;
+                valid = step(st, sign, digits_[pos + 1] - '0', st);
+            }
+            if (valid) rec(depth, st, hists[id]);
+        }
+    };
+    vector<thread> threads;
+    for (int id = 0; id < num_threads; ++id) threads.emplace_back(worker, id);
+    for (thread& th : threads) th.join();
+
+    // スレッドごとのヒストグラムをまとめる (解の例は符号が最小のものに揃える)
+    Histogram res = move(hists[0]);
+    for (int id = 1; id < num_threads; ++id) {
+        for (const auto& [v, e] : hists[id]) {
+            Entry& total = res[v];
+            total.count += e.count;
+            total.witness = min(total.witness, e.witness);
+        }
+    }
+    return res;
+}
+
+string KomachiHistogram::decode(uint64_t code) const {
+    int n = digits_.size();
+    vector<int> signs(n - 1);
+    for (int i = n - 2; i >= 0; --i) signs[i] = code % 5, code /= 5;
+    string res(1, digits_[0]);
+    for (int i = 0; i < n - 1; ++i) {
+        if (signs[i] == PLUS) res += " + ";
+        else if (signs[i] == MINUS) res += " - ";
+        else if (signs[i] == MUL) res += " * ";
+        else if (signs[i] == DIV) res += " / ";
+        res += digits_[i + 1];
+    }
+    return res;
+}
+
+int main(int argc, char** argv) {
+    // 使い方: komachi_histogram [digits] [threads] [--witness] [--integer]
+    //   --witness: 値ごとに解の例を 1 つ出力する
+    //   --integer: 整数の値のみを出力する
+    string digits = "123456789";
+    int num_threads = thread::hardware_concurrency();
+    bool witness = false, integer = false;
+    vector<string> args;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--witness") witness = true;
+        else if (arg == "--integer") integer = true;
+        else args.push_back(arg);
+    }
+    if (args.size() >= 1) digits = args[0];
+    if (args.size() >= 2) num_threads = stoi(args[1]);
+    if (num_threads <= 0) num_threads = 1;
+
+    // 演算子の入れ方をすべて 1 回ずつ列挙して、値ごとの解の個数を求める
+    KomachiHistogram komachi(digits);
+    Histogram hist = komachi.solve(num_threads);
+
+    // 値の昇順に出力する
+    vector<pair<Fraction, Entry>> res(hist.begin(), hist.end());
+    sort(res.begin(), res.end(),
+         [](const pair<Fraction, Entry>& a, const pair<Fraction, Entry>& b) {
+             return a.first < b.first;
+         });
+    cout << "The number of values: " << res.size() << endl;
+    for (const auto& [v, e] : res) {
+        if (integer && v.den != 1) continue;
+        cout << v.num;
+        if (v.den != 1) cout << "/" << v.den;
+        cout << ": " << e.count;
+        if (witness) cout << " (" << komachi.decode(e.witness) << ")";
+        cout << endl;
+    }
+}
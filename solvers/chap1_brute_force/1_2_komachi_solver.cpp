@@ -1,7 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <cmath>
+#include <cstdint>
 #include <utility>
 using namespace std;
 
@@ -12,108 +12,69 @@ const int MINUS = 2;
 const int MUL = 3;
 const int DIV = 4;
 
-// 作りたい数
-const int TARGET = 100;
-
-// □ に入れた演算子のうち、空白部分を処理する関数
-pair<vector<double>, vector<int>> calc_empty(const vector<int>& signs) {
-    // 空白部分の処理後の計算式を表すデータ
-    vector<double> new_vals;  // 数値
-    vector<int> new_signs;  // 演算子
-
-    // 途中経過の値 (小町算の最初の値は 1 である)
-    double val = 1;
-
-    // 演算子を順に見ていく
-    for (int i = 0; i < signs.size(); ++i) {
-        // 新たな数値 (i = 0, ..., 7 のとき add = 2, ..., 9)
-        double add = i + 2;
-
-        if (signs[i] == EMPTY) {
-            // 空白の場合は数値を連結する (ex: 23 * 10 + 4 = 234)
-            val = val * 10 + add;
-        } else {
-            // そうでない場合は、数値と演算子の組を新たに記録する
-            new_vals.push_back(val);
-            new_signs.push_back(signs[i]);
-
-            // □ の直後の新たな値を val に記録する
-            val = add;
+// 並べる数字と作りたい数 (コマンドライン引数で変更できる)
+string DIGITS = "123456789";
+int64_t TARGET = 100;
+
+// 128 ビット整数の最大公約数
+// 64 ビットに収まる場合は、割り算を使わない二進 GCD で高速に求める
+__int128 gcd128(__int128 a, __int128 b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    if (a <= INT64_MAX && b <= INT64_MAX) {
+        uint64_t x = (uint64_t)a, y = (uint64_t)b;
+        if (x == 0 || y == 0) return x | y;
+        int shift = __builtin_ctzll(x | y);
+        x >>= __builtin_ctzll(x);
+        while (y != 0) {
+            y >>= __builtin_ctzll(y);
+            if (x > y) swap(x, y);
+            y -= x;
         }
+        return x << shift;
     }
-
-    // 最後の値を push して、答えを返す
-    new_vals.push_back(val);
-    return make_pair(new_vals, new_signs);
+    while (b != 0) {
+        __int128 r = a % b;
+        a = b, b = r;
+    }
+    return a;
 }
 
-// 掛け算、割り算の部分を計算する関数
-pair<vector<double>, vector<int>>
-calc_mul_div(const vector<double>& vals, const vector<int>& signs) {
-    // 掛け算、割り算部分の処理後の計算式を表すデータ
-    vector<double> new_vals;  // 数値
-    vector<int> new_signs;  // 演算子
-
-    // 途中経過の値
-    double val = vals[0];
-
-    // 演算子を順に見ていく
-    for (int i = 0; i < signs.size(); ++i) {
-        // 新たな数値
-        double add = vals[i + 1];
-
-        if (signs[i] == MUL) {
-            val *= add;
-        } else if (signs[i] == DIV) {
-            val /= add;
-        } else {
-            // 掛け算、割り算でない場合は、数値と演算子の組を新たに記録する
-            new_vals.push_back(val);
-            new_signs.push_back(signs[i]);
-
-            // □ の直後の新たな値を val に記録する
-            val = add;
+// 有理数を表す構造体 (分母は常に正、既約分数で保持する)
+// 計算結果を誤差なく比較するために用いる
+struct Fraction {
+    int64_t num, den;  // 分子、分母
+
+    // コンストラクタ (途中計算は 128 ビットで行い、約分してから格納する)
+    Fraction(__int128 n = 0, __int128 d = 1) {
+        // 整数の場合は約分を省略する
+        if (d == 1) {
+            num = (int64_t)n, den = 1;
+            return;
         }
+        if (d < 0) n = -n, d = -d;
+        __int128 g = gcd128(n, d);
+        if (g > 1) n /= g, d /= g;
+        num = (int64_t)n, den = (int64_t)d;
     }
+};
 
-    // 最後の値を push して、答えを返す
-    new_vals.push_back(val);
-    return make_pair(new_vals, new_signs);
-}
-
-// 足し算、引き算の部分を計算する関数
-double calc_plus_minus
-(const vector<double>& vals, const vector<int>& signs) {
-    // 答えを表す変数
-    double res = vals[0];
-
-    // 演算子を順に見ていく
-    for (int i = 0; i < signs.size(); ++i) {
-        // 新たな数値
-        double add = vals[i + 1];
-
-        if (signs[i] == PLUS) res += add;
-        else if (signs[i] == MINUS) res -= add;
-    }
-    return res;
+// 有理数の足し算
+Fraction operator+(const Fraction& a, const Fraction& b) {
+    if (a.den == 1 && b.den == 1) return Fraction(a.num + b.num);
+    return Fraction((__int128)a.num * b.den + (__int128)b.num * a.den,
+                    (__int128)a.den * b.den);
 }
 
-// sign: 符号の入れ方を表す 8 次元ベクトル
-double calc(const vector<int>& signs) {
-    // Step 1: 空白の連結
-    pair<vector<double>, vector<int>> step1 = calc_empty(signs);
-
-    // Step 2: 掛け算、割り算
-    pair<vector<double>, vector<int>> step2
-    = calc_mul_div(step1.first, step1.second);
-
-    // Step 3: 足し算、引き算
-    return calc_plus_minus(step2.first, step2.second);
+// 項 term に数値 val を掛ける、または割る (op は MUL か DIV)
+Fraction apply(const Fraction& term, int op, int64_t val) {
+    if (op == MUL) return Fraction((__int128)term.num * val, term.den);
+    else return Fraction(term.num, (__int128)term.den * val);
 }
 
 // 数式を再現する
 string decode(const vector<int>& sign) {
-    string res = "1";
+    string res(1, DIGITS[0]);
     for (int i = 0; i < sign.size(); ++i) {
         // 演算子を追加
         if (sign[i] == PLUS) res += " + ";
@@ -122,44 +83,78 @@ string decode(const vector<int>& sign) {
         else if (sign[i] == DIV) res += " / ";
 
         // 数値を追加
-        res += to_string(i + 2);
+        res += DIGITS[i + 1];
     }
     return res;
 }
 
 // 再帰関数
-void rec(const vector<int>& vec, vector<string>& res) {
-    // 終端条件: vec のサイズが 8
-    if (vec.size() == 8) {
-        // 計算結果と 100 との差が十分小さいとき一致とみなす
-        const double EPS = 1e-9;  // 十分小さい値
-        if (abs(calc(vec) - TARGET) < EPS)
-            res.push_back(decode(vec));
-
-        // 再帰処理を終える
+// 計算式の途中経過を、次の 4 つの値で表して持ち回る
+//   sum: 確定した項の和
+//   term: 計算途中の項のうち、確定した部分 (符号を含む)
+//   op: term と cur の間の演算子 (MUL または DIV)
+//   cur: 連結中の数値
+// signs[0, pos) に入れた演算子を記録しておき、解が見つかったときだけ復元する
+void rec(int pos, const Fraction& sum, const Fraction& term, int op,
+         int64_t cur, vector<int>& signs, vector<string>& res) {
+    // 終端条件: すべての □ に演算子を入れた
+    if (pos == (int)signs.size()) {
+        // 0 で割る計算式は除外する
+        if (op == DIV && cur == 0) return;
+
+        // 計算結果 sum + n / d が作りたい数に一致するか、誤差なく判定する
+        // (n / d は最後の項で、約分せずに分母を払って比較する)
+        __int128 n = term.num, d = term.den;
+        if (op == MUL) n *= cur;
+        else d *= cur;
+        if (sum.num * d + n * sum.den == (__int128)TARGET * sum.den * d)
+            res.push_back(decode(signs));
         return;
     }
 
-    // vec の末尾に 5 値を順に挿入して試す
-    for (int add = 0; add < 5; ++add) {
-        // vec を新しい配列 vec2 にコピー
-        vector<int> vec2 = vec;
+    // 新たな数字 (pos = 0, ..., 7 のとき add = 2, ..., 9)
+    int64_t add = DIGITS[pos + 1] - '0';
+
+    // 空白の場合は数値を連結する (ex: 23 * 10 + 4 = 234)
+    signs[pos] = EMPTY;
+    rec(pos + 1, sum, term, op, cur * 10 + add, signs, res);
+
+    // 以降の演算子を入れると cur が確定する (0 で割る場合は除外する)
+    if (op == DIV && cur == 0) return;
+    Fraction closed = apply(term, op, cur);
+
+    // 足し算、引き算の場合は項が確定し、新たな項を始める
+    // (解の列挙順が元の実装と同じになるよう、演算子の番号順に試す)
+    Fraction new_sum = sum + closed;
+    signs[pos] = PLUS;
+    rec(pos + 1, new_sum, Fraction(1), MUL, add, signs, res);
+    signs[pos] = MINUS;
+    rec(pos + 1, new_sum, Fraction(-1), MUL, add, signs, res);
+
+    // 掛け算、割り算の場合は項の計算を続ける
+    signs[pos] = MUL;
+    rec(pos + 1, sum, closed, MUL, add, signs, res);
+    signs[pos] = DIV;
+    rec(pos + 1, sum, closed, DIV, add, signs, res);
+}
 
-        // vec2 の末尾に add を追加
-        vec2.push_back(add);
+int main(int argc, char** argv) {
+    // 並べる数字と作りたい数の指定 (省略時は 123456789 と 100)
+    if (argc >= 2) DIGITS = argv[1];
+    if (argc >= 3) TARGET = stoll(argv[2]);
 
-        // 再帰呼び出し
-        rec(vec2, res);
+    // 並べる数字は '0' 〜 '9' からなる空でない文字列に限る
+    if (DIGITS.empty() || DIGITS.find_first_not_of("0123456789") != string::npos) {
+        cerr << "invalid digits: " << DIGITS << " (use a non-empty string of 0-9)" << endl;
+        return 1;
     }
-}
 
-int main() {
-    // 再帰関数の処理用に、空の配列を定義
-    vector<int> vec;
+    // 演算子を記録するための配列 (□ の個数は数字の個数 - 1)
+    vector<int> signs(DIGITS.size() - 1);
 
-    // 再帰的に求める
+    // 再帰的に求める (最初の項は最初の数字から始まる)
     vector<string> res;  // 解を格納する配列
-    rec(vec, res);
+    rec(0, Fraction(0), Fraction(1), MUL, DIGITS[0] - '0', signs, res);
 
     // 答えを出力する
     cout << "The number of solutions: " << res.size() << endl;
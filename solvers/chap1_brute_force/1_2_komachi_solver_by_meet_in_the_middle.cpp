@@ -0,0 +1,440 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+using namespace std;
+
+// 演算子の種類
+const int EMPTY = 0;
+const int PLUS = 1;
+const int MINUS = 2;
+const int MUL = 3;
+const int DIV = 4;
+
+// 128 ビット整数の最大公約数
+// 64 ビットに収まる場合は、割り算を使わない二進 GCD で高速に求める
+__int128 gcd128(__int128 a, __int128 b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    if (a <= INT64_MAX && b <= INT64_MAX) {
+        uint64_t x = (uint64_t)a, y = (uint64_t)b;
+        if (x == 0 || y == 0) return x | y;
+        int shift = __builtin_ctzll(x | y);
+        x >>= __builtin_ctzll(x);
+        while (y != 0) {
+            y >>= __builtin_ctzll(y);
+            if (x > y) swap(x, y);
+            y -= x;
+        }
+        return x << shift;
+    }
+    while (b != 0) {
+        __int128 r = a % b;
+        a = b, b = r;
+    }
+    return a;
+}
+
+// 有理数を表す構造体 (分母は常に正、既約分数で保持する)
+// 20 桁程度の数字列では、分子と分母に現れる数の桁数の合計が数字列の長さ以下に
+// なるため、128 ビット整数で桁あふれせずに計算できる
+struct Fraction {
+    __int128 num, den;  // 分子、分母
+
+    // コンストラクタ (約分してから格納する)
+    Fraction(__int128 n = 0, __int128 d = 1) {
+        if (d < 0) n = -n, d = -d;
+        if (d != 1) {
+            __int128 g = gcd128(n, d);
+            if (g > 1) n /= g, d /= g;
+        }
+        num = n, den = d;
+    }
+};
+
+// 有理数の比較と四則演算 (既約分数なので、分子と分母の一致で比較できる)
+bool operator==(const Fraction& a, const Fraction& b) {
+    return a.num == b.num && a.den == b.den;
+}
+bool operator<(const Fraction& a, const Fraction& b) {
+    return a.num * b.den < b.num * a.den;
+}
+Fraction operator+(const Fraction& a, const Fraction& b) {
+    if (a.den == 1 && b.den == 1) return Fraction(a.num + b.num);
+    return Fraction(a.num * b.den + b.num * a.den, a.den * b.den);
+}
+Fraction operator-(const Fraction& a, const Fraction& b) {
+    if (a.den == 1 && b.den == 1) return Fraction(a.num - b.num);
+    return Fraction(a.num * b.den - b.num * a.den, a.den * b.den);
+}
+Fraction operator*(const Fraction& a, const Fraction& b) {
+    return Fraction(a.num * b.num, a.den * b.den);
+}
+Fraction operator/(const Fraction& a, const Fraction& b) {
+    return Fraction(a.num * b.den, a.den * b.num);
+}
+
+// 有理数をキーとするハッシュ
+struct FractionHash {
+    size_t operator()(const Fraction& f) const {
+        uint64_t h = (uint64_t)f.num ^ ((uint64_t)(f.num >> 64) * 31);
+        h = h * 0x9E3779B97F4A7C15ULL + ((uint64_t)f.den ^ (uint64_t)(f.den >> 64));
+        return h ^ (h >> 29);
+    }
+};
+
+// 値ごとに、その値になる演算子の入れ方 (5 進数で符号化したもの) を集めたハッシュ表
+using Table = unordered_map<Fraction, vector<uint64_t>, FractionHash>;
+
+// 区間の計算式の途中経過
+//   sum: 確定した項の和
+//   term: 計算途中の項のうち、確定した部分 (符号を含む)
+//   op: term と cur の間の演算子 (MUL または DIV)
+//   cur: 連結中の数値、len: cur の桁数
+struct State {
+    Fraction sum, term;
+    int op;
+    __int128 cur;
+    int len;
+};
+
+// 項 term に数値 val を掛ける、または割る (op は MUL か DIV)
+Fraction apply(const Fraction& term, int op, __int128 val) {
+    if (op == MUL) return Fraction(term.num * val, term.den);
+    else return Fraction(term.num, term.den * val);
+}
+
+// 半分全列挙で突き合わせる要素
+// 前半は (s, c) = (確定した項の和, 境界をまたぐ項のうち前半の部分)、
+// 後半は (q, r) = (境界をまたぐ項のうち後半の部分, 残りの項の和) を表し、
+// 計算式全体の値は s + c * q + r となる
+struct Item {
+    Fraction first, second;
+    uint64_t code;  // 演算子の入れ方を 5 進数で符号化したもの
+};
+
+// 値 c ごとに、値 s ごとの演算子の入れ方をまとめた表
+using Groups = unordered_map<Fraction, Table, FractionHash>;
+
+// 前半の状態: 前半の □ に演算子を入れ終えたときの途中経過と、その符号
+struct LeftState {
+    State st;
+    uint64_t code;
+};
+
+// 後半の状態: 後半の計算式を「先頭の数 x」「先頭の項で x に掛かる係数 mul」
+// 「先頭の項より後ろの項の和 rest」に分けたもの
+struct RightState {
+    __int128 x;  // 先頭の数
+    int len;  // 先頭の数の桁数
+    Fraction mul, rest;
+    uint64_t code;
+};
+
+// 小町算を半分全列挙で解くクラス
+class MeetInTheMiddleKomachi {
+ private:
+    // 並べる数字、作りたい数
+    string digits_;
+    Fraction target_;
+
+    // 前半は数字 [0, mid_]、後半は数字 [mid_ + 1, n) とし、
+    // その間の □ (境界) に入る演算子で場合分けする
+    int mid_;
+
+    // 前半、後半の状態
+    vector<LeftState> left_;
+    vector<RightState> right_;
+
+    // 解の個数と、出力用に保持する解 (演算子の配列)
+    int64_t count_;
+    size_t max_print_;
+    vector<vector<int>> found_;
+
+    int digit(int i) const { return digits_[i] - '0'; }
+
+    // 前半の □ に演算子を入れて、途中経過を列挙する
+    void enumerate_left(int pos, const State& st, uint64_t code);
+
+    // 後半の □ に演算子を入れて、途中経過を列挙する
+    void enumerate_right(int pos, vector<int>& cur);
+
+    // 前半の演算子の入れ方 lcodes、境界の演算子 mid、後半の演算子の入れ方 rcodes
+    // の組をすべて解として記録する
+    void record(int mid, const vector<uint64_t>& lcodes,
+                const vector<uint64_t>& rcodes);
+
+    // 前半の要素 (s, c) と後半の要素 (q, r) について、s + c * q + r = target_
+    // となる組をすべて数える (境界の演算子は mid)
+    void join(const vector<Item>& left, const vector<Item>& right, int mid);
+
+ public:
+    // コンストラクタ
+    MeetInTheMiddleKomachi(const string& digits, int64_t target, size_t max_print)
+        : digits_(digits), target_(Fraction(target)), max_print_(max_print) {
+        mid_ = ((int)digits_.size() - 1) / 2;
+    }
+
+    // 解の個数を返し、最大 max_print 個の解を res に格納する
+    int64_t solve(vector<string>& res);
+};
+
+void MeetInTheMiddleKomachi::enumerate_left(int pos, const State& st, uint64_t code) {
+    // 終端条件: 前半の □ (pos < mid_) すべてに演算子を入れた
+    if (pos == mid_) {
+        left_.push_back(LeftState{st, code});
+        return;
+    }
+    __int128 add = digit(pos + 1);
+
+    // 空白の場合は数値を連結する
+    enumerate_left(pos + 1, State{st.sum, st.term, st.op, st.cur * 10 + add,
+                                  st.len + 1}, code * 5 + EMPTY);
+
+    // 以降の演算子を入れると cur が確定する (0 で割る場合は除外する)
+    if (st.op == DIV && st.cur == 0) return;
+    Fraction closed = apply(st.term, st.op, st.cur);
+    enumerate_left(pos + 1, State{st.sum, closed, MUL, add, 1}, code * 5 + MUL);
+    enumerate_left(pos + 1, State{st.sum, closed, DIV, add, 1}, code * 5 + DIV);
+    Fraction sum = st.sum + closed;
+    enumerate_left(pos + 1, State{sum, Fraction(1), MUL, add, 1}, code * 5 + PLUS);
+    enumerate_left(pos + 1, State{sum, Fraction(-1), MUL, add, 1}, code * 5 + MINUS);
+}
+
+void MeetInTheMiddleKomachi::enumerate_right(int pos, vector<int>& cur) {
+    int n = digits_.size();
+
+    // 終端条件: 後半の □ すべてに演算子を入れたら、先頭の数、係数、残りの和に分ける
+    if (pos == n - 1) {
+        RightState rs{0, 0, Fraction(1), Fraction(0), 0};
+        int i = mid_ + 1;
+
+        // 先頭の数 (空白でつながる部分)
+        rs.x = digit(i), rs.len = 1;
+        while (i < n - 1 && cur[i] == EMPTY) rs.x = rs.x * 10 + digit(++i), ++rs.len;
+
+        // 先頭の項の残り (掛け算、割り算が続く部分) と、それ以降の項の和
+        State st{Fraction(0), Fraction(1), MUL, 0, 0};
+        bool first_term = true;
+        while (i < n - 1) {
+            int op = cur[i];
+            __int128 val = digit(++i);
+            while (i < n - 1 && cur[i] == EMPTY) val = val * 10 + digit(++i);
+            if (op == MUL || op == DIV) {
+                if (op == DIV && val == 0) return;
+                if (first_term) rs.mul = apply(rs.mul, op, val);
+                else st.term = apply(st.term, op, val);
+            } else {
+                if (!first_term) st.sum = st.sum + st.term;
+                first_term = false;
+                st.term = Fraction(op == PLUS ? val : -val);
+            }
+        }
+        if (!first_term) st.sum = st.sum + st.term;
+        rs.rest = st.sum;
+
+        // 演算子の入れ方を符号化する
+        for (int j = mid_ + 1; j < n - 1; ++j) rs.code = rs.code * 5 + cur[j];
+        right_.push_back(rs);
+        return;
+    }
+    for (int op = 0; op < 5; ++op) {
+        cur[pos] = op;
+        enumerate_right(pos + 1, cur);
+    }
+}
+
+void MeetInTheMiddleKomachi::record(int mid, const vector<uint64_t>& lcodes,
+                                    const vector<uint64_t>& rcodes) {
+    count_ += (int64_t)lcodes.size() * rcodes.size();
+    for (uint64_t l : lcodes) {
+        for (uint64_t r : rcodes) {
+            if (found_.size() >= max_print_) return;
+
+            // 5 進数で符号化した演算子の入れ方を復元する
+            int n = digits_.size();
+            vector<int> signs(n - 1);
+            uint64_t lc = l, rc = r;
+            for (int i = mid_ - 1; i >= 0; --i) signs[i] = lc % 5, lc /= 5;
+            signs[mid_] = mid;
+            for (int i = n - 2; i > mid_; --i) signs[i] = rc % 5, rc /= 5;
+            found_.push_back(signs);
+        }
+    }
+}
+
+void MeetInTheMiddleKomachi::join(const vector<Item>& left,
+                                  const vector<Item>& right, int mid) {
+    // 前半を c ごとに、後半を q ごとにまとめる
+    Groups left_groups, right_groups;  // left_groups[c][s], right_groups[q][r]
+    for (const Item& it : left) left_groups[it.second][it.first].push_back(it.code);
+    for (const Item& it : right) right_groups[it.first][it.second].push_back(it.code);
+
+    // 要素数が閾値以上のグループを「重い」グループとし、
+    // 軽いグループの要素は s ごと、r ごとにまとめ直す
+    // (境界をまたぐ項が長いほど、s や r の値の種類は少なくなる)
+    size_t left_limit = sqrt(left.size()) + 1, right_limit = sqrt(right.size()) + 1;
+    vector<pair<Fraction, const Table*>> heavy_left, heavy_right;
+    Groups light_left, light_right;  // light_left[s][c], light_right[r][q]
+    for (const auto& [c, table] : left_groups) {
+        if (table.size() >= left_limit) heavy_left.emplace_back(c, &table);
+        else for (const auto& [v, codes] : table) light_left[v][c] = codes;
+    }
+    for (const auto& [q, table] : right_groups) {
+        if (table.size() >= right_limit) heavy_right.emplace_back(q, &table);
+        else for (const auto& [v, codes] : table) light_right[v][q] = codes;
+    }
+
+    // 前半の重いグループ c と後半のグループ q の組: s + r = target - c * q
+    for (const auto& [c, ls] : heavy_left) {
+        for (const auto& [q, rs] : right_groups) {
+            Fraction need = target_ - c * q;
+            if (ls->size() <= rs.size()) {
+                for (const auto& [v, codes] : *ls) {
+                    auto it = rs.find(need - v);
+                    if (it != rs.end()) record(mid, codes, it->second);
+                }
+            } else {
+                for (const auto& [v, codes] : rs) {
+                    auto it = ls->find(need - v);
+                    if (it != ls->end()) record(mid, it->second, codes);
+                }
+            }
+        }
+    }
+
+    // 前半の軽いグループの要素と後半の重いグループ q の組: r = target - s - c * q
+    for (const auto& [q, rs] : heavy_right) {
+        for (const auto& [v, table] : light_left) {
+            for (const auto& [c, codes] : table) {
+                auto it = rs->find(target_ - v - c * q);
+                if (it != rs->end()) record(mid, codes, it->second);
+            }
+        }
+    }
+
+    // 軽いグループどうしの組: s と r ごとに c * q = target - s - r となる組を探す
+    for (const auto& [s, cs] : light_left) {
+        for (const auto& [r, qs] : light_right) {
+            Fraction need = target_ - s - r;
+            bool left_smaller = cs.size() <= qs.size();
+            const Table& small = left_smaller ? cs : qs;
+            const Table& large = left_smaller ? qs : cs;
+            for (const auto& [v, codes] : small) {
+                if (v.num == 0) {
+                    // 0 との積はつねに 0 になる
+                    if (need.num != 0) continue;
+                    for (const auto& [w, codes2] : large) {
+                        if (left_smaller) record(mid, codes, codes2);
+                        else record(mid, codes2, codes);
+                    }
+                } else {
+                    auto it = large.find(need / v);
+                    if (it == large.end()) continue;
+                    if (left_smaller) record(mid, codes, it->second);
+                    else record(mid, it->second, codes);
+                }
+            }
+        }
+    }
+}
+
+int64_t MeetInTheMiddleKomachi::solve(vector<string>& res) {
+    int n = digits_.size();
+    count_ = 0;
+    found_.clear();
+    left_.clear();
+    right_.clear();
+
+    // 数字が 1 個の場合は、その数字が作りたい数に一致するかどうか
+    if (n == 1) {
+        if (Fraction(digit(0)) == target_) {
+            count_ = 1;
+            res.push_back(digits_);
+        }
+        return count_;
+    }
+
+    // 前半と後半の状態をそれぞれ列挙する
+    enumerate_left(0, State{Fraction(0), Fraction(1), MUL, digit(0), 1}, 0);
+    vector<int> cur(n - 1);
+    enumerate_right(mid_ + 1, cur);
+
+    // 前半の値を s (確定した項の和)、closed (最後の項) に分けておく
+    vector<Item> left;
+    for (const LeftState& ls : left_) {
+        if (ls.st.op == DIV && ls.st.cur == 0) continue;
+        Fraction closed = apply(ls.st.term, ls.st.op, ls.st.cur);
+        left.push_back(Item{ls.st.sum, closed, ls.code});
+    }
+
+    // 境界が足し算、引き算、掛け算、割り算の場合
+    // 後半の値が x * mul + rest のとき、計算式全体の値は次のようになる
+    //   足し算: s + closed * 1 + (x * mul + rest)
+    //   引き算: s + closed * 1 + (-x * mul + rest)
+    //   掛け算: s + closed * (x * mul) + rest
+    //   割り算: s + closed * (mul / x) + rest
+    for (int mid : {PLUS, MINUS, MUL, DIV}) {
+        vector<Item> right;
+        for (const RightState& rs : right_) {
+            Fraction head = Fraction(rs.x) * rs.mul;
+            if (mid == PLUS) right.push_back(Item{Fraction(1), head + rs.rest, rs.code});
+            else if (mid == MINUS) right.push_back(Item{Fraction(1), rs.rest - head, rs.code});
+            else if (mid == MUL) right.push_back(Item{head, rs.rest, rs.code});
+            else if (rs.x != 0) right.push_back(Item{apply(rs.mul, DIV, rs.x), rs.rest, rs.code});
+        }
+        join(left, right, mid);
+    }
+
+    // 境界が空白の場合: 前半の連結中の数 cur と後半の先頭の数 x がつながって
+    // cur * 10^len + x になる
+    // 後半の先頭の数の桁数 len ごとに x は定まるので、前半の最後の項を求めてから突き合わせる
+    //   s + (term op (cur * 10^len + x)) * mul + rest
+    for (int len = 1; mid_ + len < n; ++len) {
+        __int128 x = 0, order = 1;
+        for (int i = 1; i <= len; ++i) x = x * 10 + digit(mid_ + i), order *= 10;
+        vector<Item> left_len, right_len;
+        for (const LeftState& ls : left_) {
+            __int128 number = ls.st.cur * order + x;
+            if (ls.st.op == DIV && number == 0) continue;
+            left_len.push_back(Item{ls.st.sum, apply(ls.st.term, ls.st.op, number), ls.code});
+        }
+        for (const RightState& rs : right_)
+            if (rs.len == len) right_len.push_back(Item{rs.mul, rs.rest, rs.code});
+        join(left_len, right_len, EMPTY);
+    }
+
+    // 記録した解を計算式に復元する
+    for (const vector<int>& signs : found_) {
+        string str(1, digits_[0]);
+        for (int i = 0; i < n - 1; ++i) {
+            if (signs[i] == PLUS) str += " + ";
+            else if (signs[i] == MINUS) str += " - ";
+            else if (signs[i] == MUL) str += " * ";
+            else if (signs[i] == DIV) str += " / ";
+            str += digits_[i + 1];
+        }
+        res.push_back(str);
+    }
+    return count_;
+}
+
+int main(int argc, char** argv) {
+    // 並べる数字、作りたい数、出力する解の最大個数 (省略時は 123456789、100、100 個)
+    string digits = argc >= 2 ? argv[1] : "123456789";
+    int64_t target = argc >= 3 ? stoll(argv[2]) : 100;
+    size_t max_print = argc >= 4 ? stoul(argv[3]) : 100;
+
+    // 半分全列挙で解く
+    MeetInTheMiddleKomachi solver(digits, target, max_print);
+    vector<string> res;
+    int64_t num = solver.solve(res);
+
+    // 答えを出力する
+    cout << "The number of solutions: " << num << endl;
+    for (const string& str : res)
+        cout << str << " = " << target << endl;
+}
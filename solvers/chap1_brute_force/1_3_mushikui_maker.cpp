@@ -0,0 +1,400 @@
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <chrono>
+using namespace std;
+
+// 扱える桁数の上限 (積の桁数がこれを超える問題は扱わない)
+const int MAX_DIGITS = 48;
+
+// 数字を下の桁から順に格納した固定長の配列
+using Digits = array<int, MAX_DIGITS>;
+
+// 数字 v を文字列 str の右から k 番めに当てはめても整合するか
+// (k が str の長さ以上の場合は、その桁が 0 である必要がある)
+bool is_valid_sub(int v, int k, const string& str) {
+    // 文字列より上の桁は 0 でなければならない
+    if (k >= (int)str.size()) return (v == 0);
+
+    // 右から k 番めの文字を取得する
+    char c = str[str.size() - 1 - k];
+
+    // 虫食いの場合は、左端に 0 が入らなければ問題ない
+    if (c == '*') return (v != 0 || k != (int)str.size() - 1);
+
+    // たとえば c = '8' のとき、real_val = 8 になる
+    int real_val = c - '0';
+
+    // 数値が一致するかどうかを判定する
+    return (v == real_val);
+}
+
+// 配列 digits の下から len 桁を文字列に変換する (上の桁の 0 は省く)
+string to_string(const Digits& digits, int len) {
+    while (len > 1 && digits[len - 1] == 0) --len;
+    string res;
+    for (int i = len - 1; i >= 0; --i) res += char('0' + digits[i]);
+    return res;
+}
+
+// 文字列 str に整合する整数の最小値と最大値の近似値
+// (□ には 0 または 9 を入れるが、左端の □ には 0 は入らない)
+pair<double, double> pattern_range(const string& str) {
+    double lo = 0, hi = 0;
+    for (int i = 0; i < (int)str.size(); ++i) {
+        if (str[i] == '*') {
+            lo = lo * 10 + (i == 0 ? 1 : 0);
+            hi = hi * 10 + 9;
+        } else {
+            lo = lo * 10 + (str[i] - '0');
+            hi = hi * 10 + (str[i] - '0');
+        }
+    }
+    return {lo, hi};
+}
+
+// 区間 [lo1, hi1] と区間 [lo2, hi2] が共通部分をもちうるか
+// 値は浮動小数点数による近似値なので、誤差を見込んで緩めに判定する
+bool intersects(double lo1, double hi1, double lo2, double hi2) {
+    const double EPS = 1e-9;  // 相対誤差の許容幅
+    return lo1 <= hi2 * (1 + EPS) && lo2 <= hi1 * (1 + EPS);
+}
+
+// 虫食算の解 (被乗数、乗数、積)
+struct Solution {
+    string multiplicand, multiplier, product;
+};
+
+// 虫食算ソルバーを管理するクラス
+// 被乗数と乗数の □ に、右の桁から 1 桁ずつ並行して数字を入れていく
+// 下から k + 1 桁が決まれば、部分積と積の下から k + 1 桁も決まるので、
+// 筆算と同じように繰り上がりを持ち回りながら、各桁の整合性を確認できる
+// さらに、残りの桁に入りうる数字から、部分積と積がとりうる値の範囲を求め、
+// 文字列に整合する値の範囲と重ならなければ枝刈りする
+// 数値はすべて桁ごとの配列で扱うので、桁数が大きくてもあふれない
+class Mushikuizan {
+ private:
+    // 被乗数、乗数、積
+    string multiplicand_, multiplier_, product_;
+
+    // 部分積 (middle_[j] は乗数の右から j 番めの数字に対応する)
+    vector<string> middle_;
+
+    // 部分積と積に整合する整数の範囲
+    vector<pair<double, double>> middle_range_;
+    pair<double, double> product_range_;
+
+    // plicand_rest_[k]: 被乗数の右から k 番め以降の桁に入りうる値の最小値と最大値
+    // (下の k 桁を 0 としたもの、plier_rest_ も同様)
+    vector<pair<double, double>> plicand_rest_, plier_rest_;
+
+    // 乗数の右から j 番めの桁に入りうる数字の最小値と最大値
+    vector<pair<int, int>> plier_digit_range_;
+
+    // 被乗数と乗数に入れた数字 (桁数を超える部分は 0)
+    Digits plicand_, plier_;
+
+    // 部分積 j の各桁と、各桁への繰り上がり (rows_carry_[j][k] は k 桁めへの繰り上がり)
+    vector<Digits> rows_, rows_carry_;
+
+    // 積の各桁と、各桁への繰り上がり
+    Digits prod_, prod_carry_;
+
+    // 答えを表す配列
+    vector<Solution> res_;
+
+    // 求める解の個数の上限 (0 のときは上限なし)
+    int limit_ = 0;
+
+    // 上限の個数の解が見つかったか
+    bool is_stopped() const {
+        return limit_ > 0 && (int)res_.size() >= limit_;
+    }
+
+    // 数字の配列と繰り上がりを 0 で初期化する
+    void init() {
+        plicand_.fill(0), plier_.fill(0), prod_.fill(0), prod_carry_.fill(0);
+        Digits zero;
+        zero.fill(0);
+        rows_.assign(multiplier_.size(), zero);
+        rows_carry_.assign(multiplier_.size(), zero);
+    }
+
+    // 文字列 str の右から k 番め以降の桁に入りうる値の範囲を求める
+    static vector<pair<double, double>> rest_ranges(const string& str) {
+        int n = str.size();
+        vector<pair<double, double>> res(n + 1, {0, 0});
+        double order = 1;
+        for (int k = 0; k < n; ++k) order *= 10;
+        for (int k = n - 1; k >= 0; --k) {
+            order /= 10;
+            char c = str[n - 1 - k];
+            int lo = (c == '*' ? (k == n - 1 ? 1 : 0) : c - '0');
+            int hi = (c == '*' ? 9 : c - '0');
+            res[k] = {res[k + 1].first + lo * order, res[k + 1].second + hi * order};
+        }
+        return res;
+    }
+
+    // 部分積 j の k 桁めを、被乗数の k 桁めと繰り上がりから求めて確認する
+    bool put_row_digit(int j, int k) {
+        int s = plicand_[k] * plier_[j] + rows_carry_[j][k];
+        rows_[j][k] = s % 10;
+        rows_carry_[j][k + 1] = s / 10;
+        return is_valid_sub(rows_[j][k], k, middle_[j]);
+    }
+
+    // 積の k 桁めを、k 桁めに掛かる被乗数と乗数の数字の積和から求めて確認する
+    bool put_prod_digit(int k) {
+        int s = prod_carry_[k];
+        for (int i = 0; i <= k; ++i) s += plicand_[i] * plier_[k - i];
+        prod_[k] = s % 10;
+        prod_carry_[k + 1] = s / 10;
+        return is_valid_sub(prod_[k], k, product_);
+    }
+
+    // 下から k + 1 桁が決まったときの整合性を確認する
+    // plicand, plier: 被乗数と乗数の下から k + 1 桁の値の近似値
+    bool is_consistent(int k, double plicand, double plier);
+
+    // 右から k 番めの桁に数字を入れていく再帰関数
+    // plicand, plier: 被乗数と乗数の下から k 桁の値の近似値、order: 10^k
+    void rec(int k, double plicand, double plier, double order);
+
+ public:
+    // コンストラクタ
+    Mushikuizan(const string& multiplicand,
+                const string& multiplier,
+                const string& product,
+                const vector<string>& middle) :
+        multiplicand_(multiplicand), multiplier_(multiplier),
+        product_(product), middle_(middle) {
+        for (const string& str : middle_)
+            middle_range_.push_back(pattern_range(str));
+        product_range_ = pattern_range(product_);
+        plicand_rest_ = rest_ranges(multiplicand_);
+        plier_rest_ = rest_ranges(multiplier_);
+        for (int j = 0; j < (int)multiplier_.size(); ++j) {
+            char c = multiplier_[multiplier_.size() - 1 - j];
+            if (c == '*') plier_digit_range_.emplace_back(1, 9);
+            else plier_digit_range_.emplace_back(c - '0', c - '0');
+        }
+    }
+
+    // 扱える桁数の問題かどうか
+    bool is_supported() const {
+        int len = multiplicand_.size() + multiplier_.size();
+        for (const string& str : middle_) len = max(len, (int)str.size());
+        return max(len, (int)product_.size()) + 1 < MAX_DIGITS;
+    }
+
+    // 虫食算を解く (解を格納した配列を返す)
+    // limit: 求める解の個数の上限 (0 のときは上限なし、2 にすると解の一意性を判定できる)
+    vector<Solution> solve(int limit = 0) {
+        // 答えを表す配列を空にする
+        res_.clear();
+        limit_ = limit;
+
+        // 右端の桁から数字を入れていく
+        init();
+        rec(0, 0, 0, 1);
+        return res_;
+    }
+
+    // 解の個数を数える (limit 個見つかった時点で打ち切る)
+    int count(int limit) {
+        return solve(limit).size();
+    }
+};
+
+bool Mushikuizan::is_consistent(int k, double plicand, double plier) {
+    int A = multiplicand_.size(), B = multiplier_.size();
+    int placed = min(k + 1, B);  // 数字を入れた乗数の桁数
+
+    // 部分積の k 桁めを確認する (新たに決まった部分積は下の桁からすべて)
+    for (int j = 0; j < placed; ++j) {
+        for (int i = (j == k ? 0 : k); i <= k; ++i)
+            if (!put_row_digit(j, i)) return false;
+    }
+
+    // 被乗数が決まった場合は、部分積の残りの桁 (繰り上がり) も確認する
+    if (k >= A - 1) {
+        for (int j = 0; j < placed; ++j) {
+            int len = max((int)middle_[j].size(), k + 2);
+            for (int i = k + 1; i < len; ++i) {
+                int v = (i == k + 1 ? rows_carry_[j][k + 1] : 0);
+                if (!is_valid_sub(v, i, middle_[j])) return false;
+            }
+        }
+    }
+
+    // 積の k 桁めを確認する
+    if (!put_prod_digit(k)) return false;
+
+    // 被乗数と乗数のとりうる範囲
+    double plicand_lo = plicand + plicand_rest_[min(k + 1, A)].first;
+    double plicand_hi = plicand + plicand_rest_[min(k + 1, A)].second;
+    double plier_lo = plier + plier_rest_[min(k + 1, B)].first;
+    double plier_hi = plier + plier_rest_[min(k + 1, B)].second;
+
+    // 部分積のとりうる範囲が、文字列に整合する範囲と重なるか
+    for (int j = 0; j < B; ++j) {
+        int dlo = plier_digit_range_[j].first, dhi = plier_digit_range_[j].second;
+        if (j < placed) dlo = dhi = plier_[j];
+        if (!intersects(plicand_lo * dlo, plicand_hi * dhi,
+                        middle_range_[j].first, middle_range_[j].second))
+            return false;
+    }
+
+    // 積のとりうる範囲が、文字列に整合する範囲と重なるか
+    return intersects(plicand_lo * plier_lo, plicand_hi * plier_hi,
+                      product_range_.first, product_range_.second);
+}
+
+void Mushikuizan::rec(int k, double plicand, double plier, double order) {
+    int A = multiplicand_.size(), B = multiplier_.size();
+
+    // 上限の個数の解が見つかっていれば打ち切る
+    if (is_stopped()) return;
+
+    // 終端条件: 被乗数と乗数の □ のすべてに数字が入ったとき
+    if (k == max(A, B)) {
+        // 積の残りの桁を確認する (部分積は確認済み)
+        int len = max(A + B, (int)product_.size());
+        for (int i = k; i < len; ++i)
+            if (!put_prod_digit(i)) return;
+
+        // 答えを格納する
+        res_.push_back(Solution{to_string(plicand_, A), to_string(plier_, B),
+                                to_string(prod_, len)});
+        return;
+    }
+
+    // 被乗数の右から k 番めに入れる数字の候補 (桁数を超えた場合は 0 のみ)
+    for (int a = 0; a <= (k < A ? 9 : 0); ++a) {
+        // すでに数字が入っていて矛盾している場合や、左端が 0 の場合はスキップ
+        if (k < A && !is_valid_sub(a, k, multiplicand_)) continue;
+        plicand_[k] = a;
+
+        // 乗数の右から k 番めに入れる数字の候補 (乗数に 0 は入らないものとする)
+        for (int b = (k < B ? 1 : 0); b <= (k < B ? 9 : 0); ++b) {
+            if (k < B && !is_valid_sub(b, k, multiplier_)) continue;
+            plier_[k] = b;
+
+            // 下から k + 1 桁について整合性を確認して再帰呼び出し
+            if (is_consistent(k, plicand + a * order, plier + b * order))
+                rec(k + 1, plicand + a * order, plier + b * order, order * 10);
+        }
+    }
+    plicand_[k] = plier_[k] = 0;
+}
+
+// 虫食算の問題 (lines[0]: 被乗数、lines[1]: 乗数、lines[2, B + 2): 部分積、最後: 積)
+using Problem = vector<string>;
+
+// 問題の解の個数を数える (2 個見つかった時点で打ち切る)
+int count_solutions(const Problem& problem) {
+    vector<string> middle(problem.begin() + 2, problem.end() - 1);
+    Mushikuizan mu(problem[0], problem[1], problem.back(), middle);
+    return mu.count(2);
+}
+
+// 問題を虫食算ソルバーの入力形式で出力する
+void print(const Problem& problem) {
+    cout << problem[0].size() << " " << problem[1].size() << endl;
+    cout << problem[0] << " " << problem[1] << endl;
+    for (int i = 2; i < (int)problem.size(); ++i) cout << problem[i] << endl;
+}
+
+// 問題に含まれる □ の個数
+int num_masks(const Problem& problem) {
+    int res = 0;
+    for (const string& line : problem)
+        res += count(line.begin(), line.end(), '*');
+    return res;
+}
+
+int main(int argc, char** argv) {
+    // 使い方: mushikui_maker [multiplicand digits] [multiplier digits] [iterations]
+    int A = argc >= 2 ? stoi(argv[1]) : 4;
+    int B = argc >= 3 ? stoi(argv[2]) : 3;
+    int num_iters = argc >= 4 ? stoi(argv[3]) : 100;
+
+    // 扱える桁数を超える場合は終了する
+    if (A + B + 2 >= MAX_DIGITS) {
+        cout << "Too many digits (up to " << MAX_DIGITS - 2 << ")" << endl;
+        return 0;
+    }
+
+    // 乱数のシードを固定する
+    mt19937 rand_src(1);
+
+    // 被乗数と乗数をランダムに決めて、数字がすべて埋まった筆算を作る
+    // (被乗数の左端は 0 ではなく、乗数に 0 は入らないものとする)
+    Digits plicand, plier;
+    plicand.fill(0), plier.fill(0);
+    for (int k = 0; k < A; ++k) plicand[k] = (k == A - 1 ? 1 + rand_src() % 9 : rand_src() % 10);
+    for (int k = 0; k < B; ++k) plier[k] = 1 + rand_src() % 9;
+    Problem full;
+    full.push_back(to_string(plicand, A));
+    full.push_back(to_string(plier, B));
+    Digits prod;
+    prod.fill(0);
+    for (int j = 0; j < B; ++j) {
+        // 部分積と積を筆算で求める
+        Digits row;
+        row.fill(0);
+        int carry = 0;
+        for (int k = 0; k <= A; ++k) {
+            int s = plicand[k] * plier[j] + carry;
+            row[k] = s % 10, carry = s / 10;
+        }
+        full.push_back(to_string(row, A + 1));
+        carry = 0;
+        for (int k = 0; k + j < MAX_DIGITS; ++k) {
+            int s = prod[k + j] + row[k] + carry;
+            prod[k + j] = s % 10, carry = s / 10;
+        }
+    }
+    full.push_back(to_string(prod, A + B));
+    cout << "filled multiplication:" << endl;
+    print(full);
+
+    // □ にできる候補のマス (行番号, 文字の位置)
+    vector<pair<int, int>> cells;
+    for (int i = 0; i < (int)full.size(); ++i)
+        for (int j = 0; j < (int)full[i].size(); ++j) cells.emplace_back(i, j);
+
+    // マスをランダムな順に見て、□ にしても解が一意である限り □ にしていく
+    // これを iterations 回繰り返して、□ が最も多い問題を採用する
+    Problem best = full;
+    int64_t num_checks = 0;
+    auto start = chrono::steady_clock::now();
+    for (int iter = 0; iter < num_iters; ++iter) {
+        Problem problem = full;
+        shuffle(cells.begin(), cells.end(), rand_src);
+        for (const auto& [i, j] : cells) {
+            char c = problem[i][j];
+            problem[i][j] = '*';
+            ++num_checks;
+            if (count_solutions(problem) != 1) problem[i][j] = c;
+        }
+
+        // 改善するならば置き換える
+        if (num_masks(problem) > num_masks(best)) {
+            cout << iter << ": " << num_masks(best) << " masks -> "
+                 << num_masks(problem) << " masks" << endl;
+            best = problem;
+        }
+    }
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 最終問題を出力
+    cout << "final problem (" << num_masks(best) << " masks):" << endl;
+    print(best);
+    cout << "checked masks: " << num_checks << ", time: " << sec << " sec, "
+         << num_checks / sec << " masks/sec" << endl;
+}
@@ -1,35 +1,31 @@
 #include <iostream>
 #include <vector>
+#include <array>
 #include <string>
-#include <utility>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
 using namespace std;
 
-// 整数 val が文字列 str に整合するか
-bool is_valid(int64_t val, const string& str) {
-    // 整数 val を文字列に変換する
-    string sval = to_string(val);
+// 扱える桁数の上限 (積の桁数がこれを超える問題は扱わない)
+const int MAX_DIGITS = 48;
 
-    // 整数 val の桁数が文字列 str の長さに一致する必要がある
-    if (sval.size() != str.size()) return false;
-
-    // 1 文字ずつ整合性を確認する
-    for (int i = 0; i < sval.size(); ++i) {
-        // □ については不問
-        if (str[i] == '*') continue;
-
-        // 一致しない場合は false
-        if (sval[i] != str[i]) return false;
-    }
-    return true;
-}
+// 数字を下の桁から順に格納した固定長の配列
+using Digits = array<int, MAX_DIGITS>;
 
 // 数字 v を文字列 str の右から k 番めに当てはめても整合するか
+// (k が str の長さ以上の場合は、その桁が 0 である必要がある)
 bool is_valid_sub(int v, int k, const string& str) {
+    // 文字列より上の桁は 0 でなければならない
+    if (k >= (int)str.size()) return (v == 0);
+
     // 右から k 番めの文字を取得する
     char c = str[str.size() - 1 - k];
 
-    // 虫食いの場合は問題ない
-    if (c == '*') return true;
+    // 虫食いの場合は、左端に 0 が入らなければ問題ない
+    if (c == '*') return (v != 0 || k != (int)str.size() - 1);
 
     // たとえば c = '8' のとき、real_val = 8 になる
     int real_val = c - '0';
@@ -38,28 +34,187 @@ bool is_valid_sub(int v, int k, const string& str) {
     return (v == real_val);
 }
 
-// □ に入れた数字から、整数全体を復元する
-int64_t decode(const vector<int>& vec) {
-    int64_t res = 0;  // 答え
-    int64_t order = 1;  // 1, 10, 100, ...
-    for (int v : vec) {
-        res += order * v;
-        order *= 10;
-    }
+// 配列 digits の下から len 桁を文字列に変換する (上の桁の 0 は省く)
+string to_string(const Digits& digits, int len) {
+    while (len > 1 && digits[len - 1] == 0) --len;
+    string res;
+    for (int i = len - 1; i >= 0; --i) res += char('0' + digits[i]);
     return res;
 }
 
+// 文字列 str に整合する整数の最小値と最大値の近似値
+// (□ には 0 または 9 を入れるが、左端の □ には 0 は入らない)
+pair<double, double> pattern_range(const string& str) {
+    double lo = 0, hi = 0;
+    for (int i = 0; i < (int)str.size(); ++i) {
+        if (str[i] == '*') {
+            lo = lo * 10 + (i == 0 ? 1 : 0);
+            hi = hi * 10 + 9;
+        } else {
+            lo = lo * 10 + (str[i] - '0');
+            hi = hi * 10 + (str[i] - '0');
+        }
+    }
+    return {lo, hi};
+}
+
+// 区間 [lo1, hi1] と区間 [lo2, hi2] が共通部分をもちうるか
+// 値は浮動小数点数による近似値なので、誤差を見込んで緩めに判定する
+bool intersects(double lo1, double hi1, double lo2, double hi2) {
+    const double EPS = 1e-9;  // 相対誤差の許容幅
+    return lo1 <= hi2 * (1 + EPS) && lo2 <= hi1 * (1 + EPS);
+}
+
+// 虫食算の解 (被乗数、乗数、積)
+struct Solution {
+    string multiplicand, multiplier, product;
+};
+
+// タスク 0, 1, ..., num_tasks - 1 を num_threads 個のスレッドで処理する
+// 各スレッドは自分の両端キューの末尾からタスクを取り出し、空になったら
+// 他のスレッドのキューの先頭からタスクを奪う (ワークスティーリング)
+// func(id, task): スレッド id がタスク task を処理する関数
+template<class Func> void run_work_stealing(int num_tasks, int num_threads, Func func) {
+    // タスクを順に分けて各スレッドのキューに入れる
+    vector<deque<int>> queues(num_threads);
+    vector<mutex> mutexes(num_threads);
+    for (int t = 0; t < num_tasks; ++t)
+        queues[(int64_t)t * num_threads / num_tasks].push_back(t);
+
+    auto worker = [&](int id) -> void {
+        while (true) {
+            int task = -1;
+
+            // 自分のキューの末尾から取り出す
+            {
+                lock_guard<mutex> lock(mutexes[id]);
+                if (!queues[id].empty()) {
+                    task = queues[id].back();
+                    queues[id].pop_back();
+                }
+            }
+
+            // 空の場合は、他のスレッドのキューの先頭から奪う
+            for (int i = 1; i < num_threads && task < 0; ++i) {
+                int victim = (id + i) % num_threads;
+                lock_guard<mutex> lock(mutexes[victim]);
+                if (!queues[victim].empty()) {
+                    task = queues[victim].front();
+                    queues[victim].pop_front();
+                }
+            }
+
+            // タスクは途中で増えないので、どこにも残っていなければ終了する
+            if (task < 0) break;
+            func(id, task);
+        }
+    };
+    vector<thread> threads;
+    for (int id = 0; id < num_threads; ++id) threads.emplace_back(worker, id);
+    for (thread& th : threads) th.join();
+}
+
 // 虫食算ソルバーを管理するクラス
+// 被乗数と乗数の □ に、右の桁から 1 桁ずつ並行して数字を入れていく
+// 下から k + 1 桁が決まれば、部分積と積の下から k + 1 桁も決まるので、
+// 筆算と同じように繰り上がりを持ち回りながら、各桁の整合性を確認できる
+// さらに、残りの桁に入りうる数字から、部分積と積がとりうる値の範囲を求め、
+// 文字列に整合する値の範囲と重ならなければ枝刈りする
+// 数値はすべて桁ごとの配列で扱うので、桁数が大きくてもあふれない
 class Mushikuizan {
  private:
     // 被乗数、乗数、積
     string multiplicand_, multiplier_, product_;
 
-    // 部分積
+    // 部分積 (middle_[j] は乗数の右から j 番めの数字に対応する)
     vector<string> middle_;
 
-    // 答えを表す配列 (被乗数と乗数のペアを格納)
-    vector<pair<int64_t, int64_t>> res_;
+    // 部分積と積に整合する整数の範囲
+    vector<pair<double, double>> middle_range_;
+    pair<double, double> product_range_;
+
+    // plicand_rest_[k]: 被乗数の右から k 番め以降の桁に入りうる値の最小値と最大値
+    // (下の k 桁を 0 としたもの、plier_rest_ も同様)
+    vector<pair<double, double>> plicand_rest_, plier_rest_;
+
+    // 乗数の右から j 番めの桁に入りうる数字の最小値と最大値
+    vector<pair<int, int>> plier_digit_range_;
+
+    // 被乗数と乗数に入れた数字 (桁数を超える部分は 0)
+    Digits plicand_, plier_;
+
+    // 部分積 j の各桁と、各桁への繰り上がり (rows_carry_[j][k] は k 桁めへの繰り上がり)
+    vector<Digits> rows_, rows_carry_;
+
+    // 積の各桁と、各桁への繰り上がり
+    Digits prod_, prod_carry_;
+
+    // 答えを表す配列
+    vector<Solution> res_;
+
+    // 求める解の個数の上限 (0 のときは上限なし) と、見つかった解の個数
+    // (並列に探索する場合は、スレッド間で共有するカウンタを指す)
+    int limit_ = 0;
+    atomic<int>* num_found_ = nullptr;
+
+    // 探索木を分割する場合の分割位置と、分割したタスク (被乗数と乗数の下の桁)
+    int split_depth_ = -1;
+    vector<pair<Digits, Digits>> tasks_;
+
+    // 上限の個数の解が見つかったか
+    bool is_stopped() const {
+        return limit_ > 0 && num_found_->load(memory_order_relaxed) >= limit_;
+    }
+
+    // 数字の配列と繰り上がりを 0 で初期化する
+    void init() {
+        plicand_.fill(0), plier_.fill(0), prod_.fill(0), prod_carry_.fill(0);
+        Digits zero;
+        zero.fill(0);
+        rows_.assign(multiplier_.size(), zero);
+        rows_carry_.assign(multiplier_.size(), zero);
+    }
+
+    // 文字列 str の右から k 番め以降の桁に入りうる値の範囲を求める
+    static vector<pair<double, double>> rest_ranges(const string& str) {
+        int n = str.size();
+        vector<pair<double, double>> res(n + 1, {0, 0});
+        double order = 1;
+        for (int k = 0; k < n; ++k) order *= 10;
+        for (int k = n - 1; k >= 0; --k) {
+            order /= 10;
+            char c = str[n - 1 - k];
+            int lo = (c == '*' ? (k == n - 1 ? 1 : 0) : c - '0');
+            int hi = (c == '*' ? 9 : c - '0');
+            res[k] = {res[k + 1].first + lo * order, res[k + 1].second + hi * order};
+        }
+        return res;
+    }
+
+    // 部分積 j の k 桁めを、被乗数の k 桁めと繰り上がりから求めて確認する
+    bool put_row_digit(int j, int k) {
+        int s = plicand_[k] * plier_[j] + rows_carry_[j][k];
+        rows_[j][k] = s % 10;
+        rows_carry_[j][k + 1] = s / 10;
+        return is_valid_sub(rows_[j][k], k, middle_[j]);
+    }
+
+    // 積の k 桁めを、k 桁めに掛かる被乗数と乗数の数字の積和から求めて確認する
+    bool put_prod_digit(int k) {
+        int s = prod_carry_[k];
+        for (int i = 0; i <= k; ++i) s += plicand_[i] * plier_[k - i];
+        prod_[k] = s % 10;
+        prod_carry_[k + 1] = s / 10;
+        return is_valid_sub(prod_[k], k, product_);
+    }
+
+    // 下から k + 1 桁が決まったときの整合性を確認する
+    // plicand, plier: 被乗数と乗数の下から k + 1 桁の値の近似値
+    bool is_consistent(int k, double plicand, double plier);
+
+    // 右から k 番めの桁に数字を入れていく再帰関数
+    // plicand, plier: 被乗数と乗数の下から k 桁の値の近似値、order: 10^k
+    void rec(int k, double plicand, double plier, double order);
 
  public:
     // コンストラクタ
@@ -69,81 +224,203 @@ class Mushikuizan {
                 const vector<string>& middle) :
         multiplicand_(multiplicand), multiplier_(multiplier),
         product_(product), middle_(middle) {
+        for (const string& str : middle_)
+            middle_range_.push_back(pattern_range(str));
+        product_range_ = pattern_range(product_);
+        plicand_rest_ = rest_ranges(multiplicand_);
+        plier_rest_ = rest_ranges(multiplier_);
+        for (int j = 0; j < (int)multiplier_.size(); ++j) {
+            char c = multiplier_[multiplier_.size() - 1 - j];
+            if (c == '*') plier_digit_range_.emplace_back(1, 9);
+            else plier_digit_range_.emplace_back(c - '0', c - '0');
+        }
     }
 
-    // 乗数の □ に数字を入れていく再帰関数
-    // plicand: 被乗数に入れた数字、vec: 乗数の □ に数字を入れた結果
-    void rec_plier(int64_t plicand, vector<int>& vec) {
-        // 終端条件: 乗数の □ のすべてに数字が入ったとき
-        if (vec.size() == multiplier_.size()) {
-            // 乗数を求める
-            int64_t plier = decode(vec);
+    // 扱える桁数の問題かどうか
+    bool is_supported() const {
+        int len = multiplicand_.size() + multiplier_.size();
+        for (const string& str : middle_) len = max(len, (int)str.size());
+        return max(len, (int)product_.size()) + 1 < MAX_DIGITS;
+    }
 
-            // 積の整合性を確認する
-            if (!is_valid(plicand * plier, product_)) return;
+    // 虫食算を解く (解を格納した配列を返す)
+    // limit: 求める解の個数の上限 (0 のときは上限なし、2 にすると解の一意性を判定できる)
+    vector<Solution> solve(int limit = 0) {
+        // 答えを表す配列を空にする
+        res_.clear();
+        atomic<int> num_found(0);
+        limit_ = limit, num_found_ = &num_found;
 
-            // 答えを格納する
-            res_.emplace_back(plicand, plier);
-            return;
-        }
+        // 右端の桁から数字を入れていく
+        init();
+        rec(0, 0, 0, 1);
+        num_found_ = nullptr;
+        return res_;
+    }
+
+    // 虫食算を並列に解く (解を格納した配列を返す)
+    // 下から depth 桁の数字の入れ方ごとにタスクに分けて、複数のスレッドで探索する
+    // 解はタスクの順 (solve() と同じ順) に並べる
+    // ただし上限を指定した場合は、どの解が得られるかは実行ごとに異なりうる
+    vector<Solution> solve_parallel(int num_threads, int depth, int limit = 0);
+};
 
-        // 新しい □ に数字を入れる (乗数に 0 は入らないものとする)
-        for (int add = 1; add <= 9; ++add) {
-            // すでに数字が入っていて矛盾している場合はスキップ
-            if (!is_valid_sub(add, vec.size(), multiplier_))
-                continue;
+vector<Solution> Mushikuizan::solve_parallel(int num_threads, int depth, int limit) {
+    int A = multiplicand_.size(), B = multiplier_.size();
+    atomic<int> num_found(0);
+    limit_ = limit, num_found_ = &num_found;
 
-            // □ に数字 add を入れて整合性を確認する
-            if (!is_valid(plicand * add, middle_[vec.size()]))
-                continue;
+    // 下から depth 桁までの、整合する数字の入れ方を列挙してタスクとする
+    split_depth_ = max(0, min(depth, max(A, B) - 1));
+    tasks_.clear();
+    init();
+    rec(0, 0, 0, 1);
+    int split_depth = split_depth_;
+    vector<pair<Digits, Digits>> tasks = move(tasks_);
+    split_depth_ = -1, tasks_.clear();
 
-            // vec に数字 add を加えて再帰呼び出し
-            vec.push_back(add);
-            rec_plier(plicand, vec);
-            vec.pop_back();
+    // 各スレッドは自分専用の複製を用いて、タスクの続きを探索する
+    // 見つけた解は、スレッドごとのバッファにタスク番号とともに格納する
+    vector<Mushikuizan> solvers(num_threads, *this);
+    vector<vector<pair<int, vector<Solution>>>> buffers(num_threads);
+    run_work_stealing(tasks.size(), num_threads, [&](int id, int task) -> void {
+        Mushikuizan& mu = solvers[id];
+        if (mu.is_stopped()) return;
+
+        // タスクの下の桁の数字を入れ直して、部分積と積の下の桁を求める
+        mu.init();
+        double plicand = 0, plier = 0, order = 1;
+        for (int k = 0; k < split_depth; ++k) {
+            mu.plicand_[k] = tasks[task].first[k];
+            mu.plier_[k] = tasks[task].second[k];
+            plicand += mu.plicand_[k] * order, plier += mu.plier_[k] * order;
+            mu.is_consistent(k, plicand, plier);
+            order *= 10;
         }
-    }
 
-    // 被乗数の □ に数字を入れていく関数
-    // vec: 被乗数の □ に数字を入れた結果
-    void rec_plicand(vector<int>& vec) {
-        // 終端条件: 被乗数の □ のすべてに数字が入ったとき
-        if (vec.size() == multiplicand_.size()) {
-            // 今度は乗数の □ に数字を入れていく
-            vector<int> vec2;
-            rec_plier(decode(vec), vec2);
-            return;
+        // 続きを探索する
+        mu.res_.clear();
+        mu.rec(split_depth, plicand, plier, order);
+        if (!mu.res_.empty()) buffers[id].emplace_back(task, move(mu.res_));
+    });
+    num_found_ = nullptr;
+
+    // タスク番号の順にまとめる
+    vector<pair<int, vector<Solution>>> all;
+    for (auto& buffer : buffers)
+        for (auto& p : buffer) all.push_back(move(p));
+    sort(all.begin(), all.end(),
+         [](const pair<int, vector<Solution>>& a, const pair<int, vector<Solution>>& b) {
+             return a.first < b.first;
+         });
+    vector<Solution> res;
+    for (auto& p : all) {
+        for (auto& sol : p.second) {
+            if (limit > 0 && (int)res.size() >= limit) break;
+            res.push_back(move(sol));
         }
+    }
+    return res;
+}
 
-        // 新しい □ に数字を入れる
-        for (int add = 0; add <= 9; ++add) {
-            // 左端に 0 は入れられない
-            if (vec.size() == multiplicand_.size() - 1 && add == 0) continue;
+bool Mushikuizan::is_consistent(int k, double plicand, double plier) {
+    int A = multiplicand_.size(), B = multiplier_.size();
+    int placed = min(k + 1, B);  // 数字を入れた乗数の桁数
 
-            // すでに数字が入っていて矛盾している場合はスキップ
-            if (!is_valid_sub(add, vec.size(), multiplicand_))
-                continue;
+    // 部分積の k 桁めを確認する (新たに決まった部分積は下の桁からすべて)
+    for (int j = 0; j < placed; ++j) {
+        for (int i = (j == k ? 0 : k); i <= k; ++i)
+            if (!put_row_digit(j, i)) return false;
+    }
 
-            // vec に数値 add を加えて再帰呼び出し
-            vec.push_back(add);
-            rec_plicand(vec);
-            vec.pop_back();
+    // 被乗数が決まった場合は、部分積の残りの桁 (繰り上がり) も確認する
+    if (k >= A - 1) {
+        for (int j = 0; j < placed; ++j) {
+            int len = max((int)middle_[j].size(), k + 2);
+            for (int i = k + 1; i < len; ++i) {
+                int v = (i == k + 1 ? rows_carry_[j][k + 1] : 0);
+                if (!is_valid_sub(v, i, middle_[j])) return false;
+            }
         }
     }
 
-    // 虫食算を解く (被乗数と乗数のペアを格納した配列を返す)
-    vector<pair<int64_t, int64_t>> solve() {
-        // 答えを表す配列を空にする
-        res_.clear();
+    // 積の k 桁めを確認する
+    if (!put_prod_digit(k)) return false;
 
-        // 被乗数の □ の方から数字を入れていく
-        vector<int> vec;  // 空の配列
-        rec_plicand(vec);
-        return res_;
+    // 被乗数と乗数のとりうる範囲
+    double plicand_lo = plicand + plicand_rest_[min(k + 1, A)].first;
+    double plicand_hi = plicand + plicand_rest_[min(k + 1, A)].second;
+    double plier_lo = plier + plier_rest_[min(k + 1, B)].first;
+    double plier_hi = plier + plier_rest_[min(k + 1, B)].second;
+
+    // 部分積のとりうる範囲が、文字列に整合する範囲と重なるか
+    for (int j = 0; j < B; ++j) {
+        int dlo = plier_digit_range_[j].first, dhi = plier_digit_range_[j].second;
+        if (j < placed) dlo = dhi = plier_[j];
+        if (!intersects(plicand_lo * dlo, plicand_hi * dhi,
+                        middle_range_[j].first, middle_range_[j].second))
+            return false;
     }
-};
 
-int main() {
+    // 積のとりうる範囲が、文字列に整合する範囲と重なるか
+    return intersects(plicand_lo * plier_lo, plicand_hi * plier_hi,
+                      product_range_.first, product_range_.second);
+}
+
+void Mushikuizan::rec(int k, double plicand, double plier, double order) {
+    int A = multiplicand_.size(), B = multiplier_.size();
+
+    // 上限の個数の解が見つかっていれば打ち切る
+    if (is_stopped()) return;
+
+    // 探索木を分割する場合は、分割位置まで数字を入れたらタスクとして記録する
+    if (k == split_depth_) {
+        tasks_.emplace_back(plicand_, plier_);
+        return;
+    }
+
+    // 終端条件: 被乗数と乗数の □ のすべてに数字が入ったとき
+    if (k == max(A, B)) {
+        // 積の残りの桁を確認する (部分積は確認済み)
+        int len = max(A + B, (int)product_.size());
+        for (int i = k; i < len; ++i)
+            if (!put_prod_digit(i)) return;
+
+        // 答えを格納する
+        res_.push_back(Solution{to_string(plicand_, A), to_string(plier_, B),
+                                to_string(prod_, len)});
+        num_found_->fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    // 被乗数の右から k 番めに入れる数字の候補 (桁数を超えた場合は 0 のみ)
+    for (int a = 0; a <= (k < A ? 9 : 0); ++a) {
+        // すでに数字が入っていて矛盾している場合や、左端が 0 の場合はスキップ
+        if (k < A && !is_valid_sub(a, k, multiplicand_)) continue;
+        plicand_[k] = a;
+
+        // 乗数の右から k 番めに入れる数字の候補 (乗数に 0 は入らないものとする)
+        for (int b = (k < B ? 1 : 0); b <= (k < B ? 9 : 0); ++b) {
+            if (k < B && !is_valid_sub(b, k, multiplier_)) continue;
+            plier_[k] = b;
+
+            // 下から k + 1 桁について整合性を確認して再帰呼び出し
+            if (is_consistent(k, plicand + a * order, plier + b * order))
+                rec(k + 1, plicand + a * order, plier + b * order, order * 10);
+        }
+    }
+    plicand_[k] = plier_[k] = 0;
+}
+
+int main(int argc, char** argv) {
+    // 使い方: mushikui_solver [threads] [split depth] [max solutions]
+    //   threads: スレッド数 (2 以上のとき並列に探索する)
+    //   split depth: 並列に探索する場合に、タスクに分ける下からの桁数
+    //   max solutions: 求める解の個数の上限 (0 は上限なし、2 で一意性の判定)
+    int num_threads = argc >= 2 ? stoi(argv[1]) : 1;
+    int depth = argc >= 3 ? stoi(argv[2]) : 3;
+    int limit = argc >= 4 ? stoi(argv[3]) : 0;
+
     // 入力
     cout << "Mushikuizan Input: " << endl;
     int A, B;  // 被乗数、乗数の桁数
@@ -154,16 +431,24 @@ int main() {
     for (int i = 0; i < B; ++i) cin >> middle[i];
     cin >> seki;
 
-    // 再帰的に解く
+    // 扱える桁数を超える場合は終了する
     Mushikuizan mu(hijou, jou, seki, middle);
-    const vector<pair<int64_t, int64_t>>& res = mu.solve();
+    if (!mu.is_supported()) {
+        cout << "Too many digits (up to " << MAX_DIGITS - 2 << ")" << endl;
+        return 0;
+    }
+
+    // 再帰的に解く
+    const vector<Solution>& res =
+        (num_threads >= 2 ? mu.solve_parallel(num_threads, depth, limit) : mu.solve(limit));
 
     // 解を出力
-    cout << "The num of solutions: " << res.size() << endl;
+    cout << "The num of solutions: " << res.size();
+    if (limit > 0 && (int)res.size() >= limit) cout << " (or more)";
+    cout << endl;
     for (int i = 0; i < res.size(); ++i) {
         cout << i << " th solution: "
-             << res[i].first << " * " << res[i].second
-             << " = " << res[i].first * res[i].second << endl;
+             << res[i].multiplicand << " * " << res[i].multiplier
+             << " = " << res[i].product << endl;
     }
 }
-
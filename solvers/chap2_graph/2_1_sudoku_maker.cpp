@@ -1,9 +1,14 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <set>
 #include <utility>
 #include <random>
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <chrono>
 using namespace std;
 
 // 盤面を二次元ベクトルで表す
@@ -14,9 +19,17 @@ class Sudoku {
  private:
     Field field_;
 
+    // 各行、各列、各ブロックに含まれる数字の集合 (数字 val をビット val で表す)
+    int row_[9], col_[9], box_[9];
+
+    // マス (x, y) を含むブロックの番号
+    static int box_id(int x, int y) {
+        return x / 3 * 3 + y / 3;
+    }
+
  public:
     // コンストラクタ (未確定マスの値を -1 で表す)
-    Sudoku() : field_(9, vector<int>(9, -1)) {
+    Sudoku() : field_(9, vector<int>(9, -1)), row_(), col_(), box_() {
     }
 
     // filed データを返す
@@ -27,99 +40,153 @@ class Sudoku {
     // マス (x, y) に数字 val を入れる
     void put(int x, int y, int val) {
         field_[x][y] = val;
+        row_[x] |= 1 << val;
+        col_[y] |= 1 << val;
+        box_[box_id(x, y)] |= 1 << val;
     }
 
     // マス (x, y) の数字を削除する
     void reset(int x, int y) {
+        int val = field_[x][y];
         field_[x][y] = -1;
+        row_[x] &= ~(1 << val);
+        col_[y] &= ~(1 << val);
+        box_[box_id(x, y)] &= ~(1 << val);
     }
 
-    // 入力データを受け取る
-    void input() {
-        for (int x = 0; x < 9; ++x) {
-            string line;
-            cin >> line;
+    // 入れられる数字が最も少ない空きマスを探索する (存在しない場合は false を返す)
+    bool find_most_constrained(int& x, int& y);
 
-            // マス (x, y) を処理する
-            for (int y = 0; y < 9; ++y) {
-                // 空マスの場合は -1 のままにしておく
-                if (line[y] == '*') continue;
+    // 入れられる数字が 1 つに決まるマスに、数字を入れることを繰り返す
+    //   naked single: 入れられる数字が 1 つしかないマス
+    //   hidden single: 行、列、ブロックの中で、ある数字を入れられる唯一のマス
+    // 数字を入れたマスを trail に追加する (矛盾が見つかった場合は false を返す)
+    bool propagate(vector<pair<int, int>>& trail);
 
-                // 数字に変換してマス (x, y) に入れる
-                int val = line[y] - '0';
-                put(x, y, val);
-            }
+    // trail に記録したマスのうち、先頭から size 個より後のマスの数字を削除する
+    void undo(vector<pair<int, int>>& trail, int size) {
+        while ((int)trail.size() > size) {
+            reset(trail.back().first, trail.back().second);
+            trail.pop_back();
         }
     }
 
-    // 空きマスを探索する (存在しない場合は false を返す)
-    bool find_empty(int& x, int& y);
-
-    // マス (x, y) に入れられる数字の集合を返す
-    vector<int> find_choices(int x, int y);
+    // マス (x, y) に入れられる数字の集合を返す (数字 val をビット val で表す)
+    int find_choices(int x, int y) const {
+        // 同じ行、列、ブロックのいずれにも含まれない数字
+        const int ALL = 0x3FE;  // 数字 1 〜 9 の集合
+        return ALL & ~(row_[x] | col_[y] | box_[box_id(x, y)]);
+    }
 };
 
-// 空きマスを探索する (存在しない場合は false を返す)
-bool Sudoku::find_empty(int& x, int& y) {
-    for (x = 0; x < 9; ++x)
-        for (y = 0; y < 9; ++y)
-            if (field_[x][y] == -1)
-                return true;
-    return false;
+// 入れられる数字が最も少ない空きマスを探索する (存在しない場合は false を返す)
+bool Sudoku::find_most_constrained(int& x, int& y) {
+    int min_num = 10;
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            if (field_[i][j] != -1) continue;
+            int num = __builtin_popcount(find_choices(i, j));
+            if (num < min_num) {
+                min_num = num, x = i, y = j;
+                if (num <= 1) return true;
+            }
+        }
+    }
+    return min_num < 10;
 }
 
-// マス (x, y) に入れられる数字の集合を返す
-vector<int> Sudoku::find_choices(int x, int y) {
-    // マス (x, y) と同じ行、列、ブロックにある数字を求める
-    set<int> cannot_use;
-
-    // 同じ行に含まれる数字を除外する
-    for (int i = 0; i < 9; ++i)
-        if (field_[x][i] != -1)
-            cannot_use.insert(field_[x][i]);
-
-    // 同じ列に含まれる数字を除外する
-    for (int i = 0; i < 9; ++i)
-        if (field_[i][y] != -1)
-            cannot_use.insert(field_[i][y]);
-
-    // 同じブロックに含まれる数字を除外する
-    int x2 = x / 3 * 3, y2 = y / 3 * 3;  // 同じブロックの左上のマス
-    for (int i = x2; i < x2 + 3; ++i)
-        for (int j = y2; j < y2 + 3; ++j)
-            if (field_[i][j] != -1)
-                cannot_use.insert(field_[i][j]);
-
-    // マス (x, y) に入れられる数字からなる配列を求める
-    vector<int> res;
-    for (int val = 1; val <= 9; ++val)
-        if (!cannot_use.count(val))
-            res.push_back(val);
-    return res;
+// 入れられる数字が 1 つに決まるマスに、数字を入れることを繰り返す
+bool Sudoku::propagate(vector<pair<int, int>>& trail) {
+    const int ALL = 0x3FE;  // 数字 1 〜 9 の集合
+    bool updated = true;
+    while (updated) {
+        updated = false;
+
+        // naked single: 入れられる数字が 1 つしかないマス
+        for (int x = 0; x < 9; ++x) {
+            for (int y = 0; y < 9; ++y) {
+                if (field_[x][y] != -1) continue;
+                int choices = find_choices(x, y);
+                if (choices == 0) return false;
+                if (choices & (choices - 1)) continue;
+                put(x, y, __builtin_ctz(choices));
+                trail.emplace_back(x, y);
+                updated = true;
+            }
+        }
+
+        // hidden single: 行、列、ブロック (unit = 0, 1, 2) の中で、
+        // ある数字を入れられるマスが 1 つしかない場合は、そのマスに入れる
+        for (int unit = 0; unit < 3; ++unit) {
+            for (int id = 0; id < 9; ++id) {
+                // once: 入れられるマスが 1 つ以上ある数字
+                // twice: 入れられるマスが 2 つ以上ある数字
+                int once = 0, twice = 0, used = 0;
+                for (int k = 0; k < 9; ++k) {
+                    int x = (unit == 0 ? id : unit == 1 ? k : id / 3 * 3 + k / 3);
+                    int y = (unit == 0 ? k : unit == 1 ? id : id % 3 * 3 + k % 3);
+                    if (field_[x][y] != -1) {
+                        used |= 1 << field_[x][y];
+                        continue;
+                    }
+                    int choices = find_choices(x, y);
+                    twice |= once & choices;
+                    once |= choices;
+                }
+
+                // どのマスにも入れられない数字があれば矛盾
+                if ((once | used) != ALL) return false;
+
+                // 入れられるマスが 1 つしかない数字を入れる
+                int single = once & ~twice;
+                if (single == 0) continue;
+                for (int k = 0; k < 9; ++k) {
+                    int x = (unit == 0 ? id : unit == 1 ? k : id / 3 * 3 + k / 3);
+                    int y = (unit == 0 ? k : unit == 1 ? id : id % 3 * 3 + k % 3);
+                    if (field_[x][y] != -1) continue;
+                    int choices = find_choices(x, y) & single;
+                    if (choices == 0) continue;
+
+                    // 1 つのマスに 2 つの数字を入れる必要がある場合は矛盾
+                    if (choices & (choices - 1)) return false;
+                    put(x, y, __builtin_ctz(choices));
+                    trail.emplace_back(x, y);
+                    updated = true;
+                }
+            }
+        }
+    }
+    return true;
 }
 
-// 数独を解くための再帰関数
-void dfs(Sudoku& board, vector<Field>& res, bool all = true) {
+// 数独を解くための再帰関数 (候補の少ないマスから埋め、確定するマスを先に埋める)
+void dfs_mrv(Sudoku& board, vector<Field>& res, bool all = true) {
     // フラグ all が false のときは、解を 1 個求めたら抜ける
     if (!all && !res.empty()) return;
 
-    // 空きマスを探す (存在しない場合は終端条件)
+    // 数字が 1 つに決まるマスを埋める (矛盾した場合は元に戻して抜ける)
+    vector<pair<int, int>> trail;
+    if (!board.propagate(trail)) {
+        board.undo(trail, 0);
+        return;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探す (存在しない場合は終端条件)
     int x, y;
-    if (!board.find_empty(x, y)) {
+    if (!board.find_most_constrained(x, y)) {
         // 解に追加
         res.push_back(board.get());
-        return;
+    } else {
+        // 空きマス (x, y) に数字を小さい順に入れていく
+        for (int can_use = board.find_choices(x, y); can_use; can_use &= can_use - 1) {
+            board.put(x, y, __builtin_ctz(can_use));  // マス (x, y) に数字を入れる
+            dfs_mrv(board, res, all);  // 再帰呼び出し
+            board.reset(x, y);  // マス (x, y) の数字を削除
+        }
     }
 
-    // マス (x, y) に入れられる数字の集合を求める
-    const vector<int>& can_use = board.find_choices(x, y);
-
-    // 空きマス (x, y) に数字を順に入れていく
-    for (int val : can_use) {
-        board.put(x, y, val);  // マス (x, y) に数字 val を入れる
-        dfs(board, res, all);  // 再帰呼び出し
-        board.reset(x, y);  // マス (x, y) の数字を削除
-    }
+    // 埋めたマスを元に戻す
+    board.undo(trail, 0);
 }
 
 // 数独を解く
@@ -128,10 +195,47 @@ vector<Field> solve(Sudoku& board, bool all = true) {
     vector<Field> res;
 
     // 再帰関数を呼び出す
-    dfs(board, res, all);
+    dfs_mrv(board, res, all);
     return res;
 }
 
+// 数独の解の個数を数えるための再帰関数 (盤面は複製せずに個数だけを数える)
+// num が limit に達したら打ち切る (limit が 0 のときは上限なし)
+// 探索の手間として、呼び出し回数を nodes に加える
+void dfs_count(Sudoku& board, int64_t& num, int64_t limit, int64_t& nodes) {
+    if (limit > 0 && num >= limit) return;
+    ++nodes;
+
+    // 数字が 1 つに決まるマスを埋める (矛盾した場合は元に戻して抜ける)
+    vector<pair<int, int>> trail;
+    if (!board.propagate(trail)) {
+        board.undo(trail, 0);
+        return;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探す (存在しない場合は終端条件)
+    int x, y;
+    if (!board.find_most_constrained(x, y)) {
+        ++num;
+    } else {
+        for (int can_use = board.find_choices(x, y); can_use; can_use &= can_use - 1) {
+            board.put(x, y, __builtin_ctz(can_use));
+            dfs_count(board, num, limit, nodes);
+            board.reset(x, y);
+        }
+    }
+    board.undo(trail, 0);
+}
+
+// 数独の解の個数を数える (limit 個に達した時点で打ち切る)
+// nodes を指定した場合は、探索した節点の個数を加える
+int64_t count(Sudoku& board, int64_t limit = 0, int64_t* nodes = nullptr) {
+    int64_t num = 0, num_nodes = 0;
+    dfs_count(board, num, limit, num_nodes);
+    if (nodes) *nodes += num_nodes;
+    return num;
+}
+
 // 数独の盤面を出力する関数
 void print(const Sudoku& board) {
     const Field& field = board.get();
@@ -146,7 +250,118 @@ void print(const Sudoku& board) {
     }
 }
 
-int main() {
+// 一意解の問題を 1 つ作る (乱数は (seed, id) から作るので、問題 id ごとに再現できる)
+// ランダムな完全な盤面を作り、ランダムな順にヒントを 1 つずつ取り除く
+// 取り除くと解が一意でなくなるヒントは残すので、得られる問題は極小になる
+// 一意性の判定で探索した節点の個数を nodes に格納する
+string make_minimal(uint32_t seed, uint32_t id, int& num_clues, int64_t& nodes) {
+    seed_seq seq{seed, id};
+    mt19937 rand_src(seq);
+
+    // 対角線上の 3 つのブロックは互いに独立なので、ランダムな順列で埋める
+    // 残りのマスは解の 1 つで埋める
+    Sudoku board;
+    for (int b = 0; b < 3; ++b) {
+        vector<int> perm = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+        shuffle(perm.begin(), perm.end(), rand_src);
+        for (int k = 0; k < 9; ++k) board.put(b * 3 + k / 3, b * 3 + k % 3, perm[k]);
+    }
+    Field full = solve(board, false)[0];
+    for (int x = 0; x < 9; ++x)
+        for (int y = 0; y < 9; ++y)
+            if (board.get()[x][y] == -1) board.put(x, y, full[x][y]);
+
+    // ランダムな順にヒントを取り除き、解が一意でなくなる場合は元に戻す
+    // 取り除く前の盤面は一意解 full をもつので、取り除いた後の別の解は
+    // そのマスの数字が full と異なる
+    // よって、そのマスに他の数字を入れた盤面に解がないかどうかを調べればよい
+    vector<int> order(81);
+    for (int i = 0; i < 81; ++i) order[i] = i;
+    shuffle(order.begin(), order.end(), rand_src);
+    nodes = 0, num_clues = 81;
+    for (int i : order) {
+        int x = i / 9, y = i % 9, val = full[x][y];
+        board.reset(x, y);
+        bool unique = true;
+        int can_use = board.find_choices(x, y) & ~(1 << val);
+        for (; can_use && unique; can_use &= can_use - 1) {
+            board.put(x, y, __builtin_ctz(can_use));
+            if (count(board, 1, &nodes) > 0) unique = false;
+            board.reset(x, y);
+        }
+        if (unique) --num_clues;
+        else board.put(x, y, val);
+    }
+
+    string res;
+    for (const vector<int>& row : board.get())
+        for (int val : row) res += (val == -1 ? '*' : char('0' + val));
+    return res;
+}
+
+// 一意解の問題を num_puzzles 個作り、1 行に 1 問ずつ out に書き出す
+// 各行は「81 文字の盤面 ('*' は空きマス)、ヒントの個数、探索した節点の個数」
+// 問題はバッチごとに並列に作り、問題番号の順に書き出す
+void make_stream(ostream& out, int64_t num_puzzles, int num_threads, uint32_t seed) {
+    const int BATCH = 10000;  // 一度に並列に作る問題数
+    int64_t total_clues = 0;
+    auto start = chrono::steady_clock::now();
+    for (int64_t first = 0; first < num_puzzles; first += BATCH) {
+        int size = (int)min<int64_t>(BATCH, num_puzzles - first);
+        vector<string> lines(size);
+        vector<int> clues(size);
+        atomic<int> next(0);
+        auto worker = [&]() -> void {
+            while (true) {
+                int i = next.fetch_add(1);
+                if (i >= size) break;
+                int64_t nodes;
+                string puzzle = make_minimal(seed, first + i, clues[i], nodes);
+                lines[i] = puzzle + " " + to_string(clues[i]) + " " + to_string(nodes);
+            }
+        };
+        vector<thread> threads;
+        for (int id = 0; id < num_threads; ++id) threads.emplace_back(worker);
+        for (thread& th : threads) th.join();
+
+        for (int i = 0; i < size; ++i) {
+            out << lines[i] << '\n';
+            total_clues += clues[i];
+        }
+    }
+    out << flush;
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 生成速度と平均ヒント数を出力する
+    cerr << "puzzles: " << num_puzzles << ", threads: " << num_threads
+         << ", time: " << sec << " sec, " << num_puzzles / sec << " puzzles/sec" << endl;
+    if (num_puzzles > 0)
+        cerr << "average clues: " << (double)total_clues / num_puzzles << endl;
+}
+
+int main(int argc, char** argv) {
+    // 使い方:
+    //   sudoku_maker: ピンク色マスの配置 (9 行) を入力し、一意解の問題を 1 つ作る
+    //   sudoku_maker --stream [num] [file] [threads] [seed]: ランダムな一意解の問題を
+    //     num 個作り、file に書き出す (file を省略するか "-" とした場合は標準出力)
+    if (argc >= 2 && string(argv[1]) == "--stream") {
+        int64_t num_puzzles = argc >= 3 ? stoll(argv[2]) : 10000;
+        int num_threads = argc >= 5 ? stoi(argv[4]) : thread::hardware_concurrency();
+        uint32_t seed = argc >= 6 ? stoul(argv[5]) : 1;
+        if (num_threads <= 0) num_threads = 1;
+        if (argc >= 4 && string(argv[3]) != "-") {
+            ofstream file(argv[3]);
+            if (!file) {
+                cerr << "cannot open " << argv[3] << endl;
+                return 1;
+            }
+            make_stream(file, num_puzzles, num_threads, seed);
+        } else {
+            make_stream(cout, num_puzzles, num_threads, seed);
+        }
+        return 0;
+    }
+
     // 乱数のシードを固定する
     mt19937 rand_src(1);
 
@@ -171,9 +386,8 @@ int main() {
     for (pair<int, int> p : cells)
         board.put(p.first, p.second, res[0][p.first][p.second]);
 
-    // 初期盤面を改めて解く
-    res = solve(board);
-    int score = res.size();  // 解の個数を初期スコアとする
+    // 解の個数を初期スコアとする
+    int64_t score = count(board);
     cout << "initial problem: " << score << " sols" << endl;
     print(board);
 
@@ -186,6 +400,7 @@ int main() {
         Sudoku board2 = board;
 
         // 「ピンク色マスの数字をランダムに変更する」を 2 回実施する
+        vector<pair<int, int>> changed;  // 変更したマス
         for (int con = 0; con < 2; ++con) {
             // ピンク色マスをランダムに選び、一旦数字を削除する
             int id = rand_src() % cells.size();
@@ -193,14 +408,21 @@ int main() {
             board2.reset(x, y);
 
             // 選んだマスに入れられる数字をランダムに選んで入れる
-            vector<int> can = board2.find_choices(x, y);
-            int val = can[rand_src() % can.size()];
-            board2.put(x, y, val);
+            int can = board2.find_choices(x, y);
+            for (int k = rand_src() % __builtin_popcount(can); k > 0; --k) can &= can - 1;
+            board2.put(x, y, __builtin_ctz(can));
+            changed.emplace_back(x, y);
         }
 
-        // 新たな盤面で数独を解く
-        res = solve(board2);
-        int new_score = res.size();  // 新たな盤面の解の個数
+        // 変更したマスの数字がすべて元と同じならば、盤面は変わらないので解き直さない
+        bool same = true;
+        for (const auto& [x, y] : changed)
+            same = same && (board2.get()[x][y] == board.get()[x][y]);
+        if (same) continue;
+
+        // 新たな盤面の解の個数を数える
+        // (スコア以上の個数の解が見つかった時点で、改善しないことがわかるので打ち切る)
+        int64_t new_score = count(board2, score);
 
         // 改善するならば置き換える
         if (new_score < score && new_score != 0) {
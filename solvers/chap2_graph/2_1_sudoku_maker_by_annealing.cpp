@@ -0,0 +1,388 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <random>
+#include <cstdint>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+using namespace std;
+
+// 盤面を二次元ベクトルで表す
+using Field = vector<vector<int>>;
+
+// 数独を解くためのクラス
+class Sudoku {
+ private:
+    Field field_;
+
+    // 各行、各列、各ブロックに含まれる数字の集合 (数字 val をビット val で表す)
+    int row_[9], col_[9], box_[9];
+
+    // マス (x, y) を含むブロックの番号
+    static int box_id(int x, int y) {
+        return x / 3 * 3 + y / 3;
+    }
+
+ public:
+    // コンストラクタ (未確定マスの値を -1 で表す)
+    Sudoku() : field_(9, vector<int>(9, -1)), row_(), col_(), box_() {
+    }
+
+    // filed データを返す
+    const Field& get() const {
+        return field_;
+    }
+
+    // マス (x, y) に数字 val を入れる
+    void put(int x, int y, int val) {
+        field_[x][y] = val;
+        row_[x] |= 1 << val;
+        col_[y] |= 1 << val;
+        box_[box_id(x, y)] |= 1 << val;
+    }
+
+    // マス (x, y) の数字を削除する
+    void reset(int x, int y) {
+        int val = field_[x][y];
+        field_[x][y] = -1;
+        row_[x] &= ~(1 << val);
+        col_[y] &= ~(1 << val);
+        box_[box_id(x, y)] &= ~(1 << val);
+    }
+
+    // 入れられる数字が最も少ない空きマスを探索する (存在しない場合は false を返す)
+    bool find_most_constrained(int& x, int& y);
+
+    // 入れられる数字が 1 つに決まるマスに、数字を入れることを繰り返す
+    //   naked single: 入れられる数字が 1 つしかないマス
+    //   hidden single: 行、列、ブロックの中で、ある数字を入れられる唯一のマス
+    // 数字を入れたマスを trail に追加する (矛盾が見つかった場合は false を返す)
+    bool propagate(vector<pair<int, int>>& trail);
+
+    // trail に記録したマスのうち、先頭から size 個より後のマスの数字を削除する
+    void undo(vector<pair<int, int>>& trail, int size) {
+        while ((int)trail.size() > size) {
+            reset(trail.back().first, trail.back().second);
+            trail.pop_back();
+        }
+    }
+
+    // マス (x, y) に入れられる数字の集合を返す (数字 val をビット val で表す)
+    int find_choices(int x, int y) const {
+        // 同じ行、列、ブロックのいずれにも含まれない数字
+        const int ALL = 0x3FE;  // 数字 1 〜 9 の集合
+        return ALL & ~(row_[x] | col_[y] | box_[box_id(x, y)]);
+    }
+};
+
+// 入れられる数字が最も少ない空きマスを探索する (存在しない場合は false を返す)
+bool Sudoku::find_most_constrained(int& x, int& y) {
+    int min_num = 10;
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            if (field_[i][j] != -1) continue;
+            int num = __builtin_popcount(find_choices(i, j));
+            if (num < min_num) {
+                min_num = num, x = i, y = j;
+                if (num <= 1) return true;
+            }
+        }
+    }
+    return min_num < 10;
+}
+
+// 入れられる数字が 1 つに決まるマスに、数字を入れることを繰り返す
+bool Sudoku::propagate(vector<pair<int, int>>& trail) {
+    const int ALL = 0x3FE;  // 数字 1 〜 9 の集合
+    bool updated = true;
+    while (updated) {
+        updated = false;
+
+        // naked single: 入れられる数字が 1 つしかないマス
+        for (int x = 0; x < 9; ++x) {
+            for (int y = 0; y < 9; ++y) {
+                if (field_[x][y] != -1) continue;
+                int choices = find_choices(x, y);
+                if (choices == 0) return false;
+                if (choices & (choices - 1)) continue;
+                put(x, y, __builtin_ctz(choices));
+                trail.emplace_back(x, y);
+                updated = true;
+            }
+        }
+
+        // hidden single: 行、列、ブロック (unit = 0, 1, 2) の中で、
+        // ある数字を入れられるマスが 1 つしかない場合は、そのマスに入れる
+        for (int unit = 0; unit < 3; ++unit) {
+            for (int id = 0; id < 9; ++id) {
+                // once: 入れられるマスが 1 つ以上ある数字
+                // twice: 入れられるマスが 2 つ以上ある数字
+                int once = 0, twice = 0, used = 0;
+                for (int k = 0; k < 9; ++k) {
+                    int x = (unit == 0 ? id : unit == 1 ? k : id / 3 * 3 + k / 3);
+                    int y = (unit == 0 ? k : unit == 1 ? id : id % 3 * 3 + k % 3);
+                    if (field_[x][y] != -1) {
+                        used |= 1 << field_[x][y];
+                        continue;
+                    }
+                    int choices = find_choices(x, y);
+                    twice |= once & choices;
+                    once |= choices;
+                }
+
+                // どのマスにも入れられない数字があれば矛盾
+                if ((once | used) != ALL) return false;
+
+                // 入れられるマスが 1 つしかない数字を入れる
+                int single = once & ~twice;
+                if (single == 0) continue;
+                for (int k = 0; k < 9; ++k) {
+                    int x = (unit == 0 ? id : unit == 1 ? k : id / 3 * 3 + k / 3);
+                    int y = (unit == 0 ? k : unit == 1 ? id : id % 3 * 3 + k % 3);
+                    if (field_[x][y] != -1) continue;
+                    int choices = find_choices(x, y) & single;
+                    if (choices == 0) continue;
+
+                    // 1 つのマスに 2 つの数字を入れる必要がある場合は矛盾
+                    if (choices & (choices - 1)) return false;
+                    put(x, y, __builtin_ctz(choices));
+                    trail.emplace_back(x, y);
+                    updated = true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// 数独を解くための再帰関数 (候補の少ないマスから埋め、確定するマスを先に埋める)
+void dfs_mrv(Sudoku& board, vector<Field>& res, bool all = true) {
+    // フラグ all が false のときは、解を 1 個求めたら抜ける
+    if (!all && !res.empty()) return;
+
+    // 数字が 1 つに決まるマスを埋める (矛盾した場合は元に戻して抜ける)
+    vector<pair<int, int>> trail;
+    if (!board.propagate(trail)) {
+        board.undo(trail, 0);
+        return;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探す (存在しない場合は終端条件)
+    int x, y;
+    if (!board.find_most_constrained(x, y)) {
+        // 解に追加
+        res.push_back(board.get());
+    } else {
+        // 空きマス (x, y) に数字を小さい順に入れていく
+        for (int can_use = board.find_choices(x, y); can_use; can_use &= can_use - 1) {
+            board.put(x, y, __builtin_ctz(can_use));  // マス (x, y) に数字を入れる
+            dfs_mrv(board, res, all);  // 再帰呼び出し
+            board.reset(x, y);  // マス (x, y) の数字を削除
+        }
+    }
+
+    // 埋めたマスを元に戻す
+    board.undo(trail, 0);
+}
+
+// 数独を解く
+vector<Field> solve(Sudoku& board, bool all = true) {
+    // 答えを格納した配列
+    vector<Field> res;
+
+    // 再帰関数を呼び出す
+    dfs_mrv(board, res, all);
+    return res;
+}
+
+// 数独の解の個数を数えるための再帰関数 (盤面は複製せずに個数だけを数える)
+// num が limit に達したら打ち切る (limit が 0 のときは上限なし)
+void dfs_count(Sudoku& board, int64_t& num, int64_t limit) {
+    if (limit > 0 && num >= limit) return;
+
+    // 数字が 1 つに決まるマスを埋める (矛盾した場合は元に戻して抜ける)
+    vector<pair<int, int>> trail;
+    if (!board.propagate(trail)) {
+        board.undo(trail, 0);
+        return;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探す (存在しない場合は終端条件)
+    int x, y;
+    if (!board.find_most_constrained(x, y)) {
+        ++num;
+    } else {
+        for (int can_use = board.find_choices(x, y); can_use; can_use &= can_use - 1) {
+            board.put(x, y, __builtin_ctz(can_use));
+            dfs_count(board, num, limit);
+            board.reset(x, y);
+        }
+    }
+    board.undo(trail, 0);
+}
+
+// 数独の解の個数を数える (limit 個に達した時点で打ち切る)
+int64_t count(Sudoku& board, int64_t limit = 0) {
+    int64_t num = 0;
+    dfs_count(board, num, limit);
+    return num;
+}
+
+// 数独の盤面を出力する関数
+void print(const Sudoku& board) {
+    const Field& field = board.get();
+    for (int x = 0; x < 9; ++x) {
+        for (int y = 0; y < 9; ++y) {
+            if (field[x][y] == -1)
+                cout << "*";
+            else
+                cout << field[x][y];
+        }
+        cout << endl;
+    }
+}
+
+// 1 本の焼きなまし法の探索 (チェイン) の結果
+struct ChainResult {
+    int chain = -1;          // チェインの番号
+    int64_t score = -1;      // 最良の盤面の解の個数
+    int64_t iterations = 0;  // 実行した反復回数
+    Sudoku board;            // 最良の盤面
+};
+
+// 解の個数を数える上限 (これ以上の個数はすべて MAX_SCORE として扱う)
+// 手がかりの少ない盤面でも、すべての解を列挙せずに済むようにする
+const int64_t MAX_SCORE = 1000;
+
+// 焼きなまし法で一意解の問題を探す
+// ピンク色マスの数字を 2 つ変更する近傍を用い、解の個数 (MAX_SCORE で打ち切る) の
+// 対数をエネルギーとする
+// 初期盤面 initial の解の個数 initial_score は呼び出し側で 1 度だけ数えておく
+// 悪化する変更も温度に応じた確率で受け入れ、温度は T0 から T1 まで指数的に下げる
+// 乱数は (seed, chain) から作るので、チェインごとの探索は再現できる
+// cancel が立ったら打ち切る
+ChainResult anneal(const Sudoku& initial, int64_t initial_score,
+                   const vector<pair<int, int>>& cells, int64_t num_iters,
+                   uint32_t seed, int chain, const atomic<bool>& cancel) {
+    const double T0 = 1.0, T1 = 0.01;  // 初期温度と最終温度
+    seed_seq seq{seed, (uint32_t)chain};
+    mt19937 rand_src(seq);
+    uniform_real_distribution<double> unif(0.0, 1.0);
+
+    Sudoku board = initial;
+    int64_t score = initial_score;
+
+    ChainResult res;
+    res.chain = chain, res.score = score, res.board = board;
+    for (int64_t iter = 0; iter < num_iters && score > 1; ++iter) {
+        if (cancel.load(memory_order_relaxed)) break;
+        res.iterations = iter + 1;
+
+        // 新たな盤面を作る (ピンク色マスの数字をランダムに 2 回変更する)
+        Sudoku board2 = board;
+        for (int con = 0; con < 2; ++con) {
+            int id = rand_src() % cells.size();
+            int x = cells[id].first, y = cells[id].second;
+            board2.reset(x, y);
+            int can = board2.find_choices(x, y);
+            for (int k = rand_src() % __builtin_popcount(can); k > 0; --k) can &= can - 1;
+            board2.put(x, y, __builtin_ctz(can));
+        }
+
+        // 解の個数を数える (受け入れられる見込みのない大きな個数は上限で打ち切る)
+        int64_t limit = min(score * 8, MAX_SCORE);
+        int64_t new_score = count(board2, limit);
+        if (new_score == 0) continue;
+
+        // 温度に応じて受け入れるかどうかを決める
+        double temp = T0 * pow(T1 / T0, (double)iter / num_iters);
+        double diff = log((double)new_score) - log((double)score);
+        if (diff <= 0 || unif(rand_src) < exp(-diff / temp)) {
+            board = board2;
+            score = new_score;
+            if (score < res.score) res.score = score, res.board = board;
+        }
+    }
+    return res;
+}
+
+int main(int argc, char** argv) {
+    // 使い方: sudoku_maker_by_annealing [threads] [chains] [iterations] [seed]
+    //   chains 本のチェインを threads 個のスレッドで実行し、
+    //   最初に一意解の問題を見つけたチェインが他のチェインを打ち切る
+    int num_threads = argc >= 2 ? stoi(argv[1]) : thread::hardware_concurrency();
+    int num_chains = argc >= 3 ? stoi(argv[2]) : 64;
+    int64_t num_iters = argc >= 4 ? stoll(argv[3]) : 10000;
+    uint32_t seed = argc >= 5 ? stoul(argv[4]) : 1;
+    if (num_threads <= 0) num_threads = 1;
+
+    // 数独を入力する
+    Sudoku board;
+    vector<pair<int, int>> cells;  // ピンク色マスの集合
+    for (int x = 0; x < 9; ++x) {
+        string line;
+        cin >> line;
+        for (int y = 0; y < 9; ++y) {
+            if (line[y] >= '0' && line[y] <= '9') {
+                int val = line[y] - '0';
+                board.put(x, y, val);
+            } else if (line[y] == 'o') {
+                cells.emplace_back(x, y);
+            }
+        }
+    }
+
+    // 数独を最初に解き、解の 1 つを board に入力して初期解とする
+    vector<Field> res = solve(board, false);
+    if (res.empty()) {
+        cout << "No solutions." << endl;
+        return 0;
+    }
+    for (pair<int, int> p : cells)
+        board.put(p.first, p.second, res[0][p.first][p.second]);
+    int64_t initial_score = count(board, MAX_SCORE);
+    if (initial_score >= MAX_SCORE)
+        cout << "initial problem: " << MAX_SCORE << " or more sols" << endl;
+    else
+        cout << "initial problem: " << initial_score << " sols" << endl;
+    print(board);
+
+    // 各スレッドは未実行のチェインを順に取り出して実行する
+    // 一意解の問題を最初に見つけたチェインが cancel を立てる
+    atomic<int> next_chain(0);
+    atomic<bool> cancel(false);
+    mutex mtx;
+    ChainResult best;
+    auto start = chrono::steady_clock::now();
+    auto worker = [&]() -> void {
+        while (!cancel.load()) {
+            int chain = next_chain.fetch_add(1);
+            if (chain >= num_chains) break;
+            ChainResult r = anneal(board, initial_score, cells, num_iters, seed,
+                                   chain, cancel);
+
+            // 最良の結果を更新する (解の個数が同じ場合はチェインの番号が小さい方)
+            lock_guard<mutex> lock(mtx);
+            if (r.score == 1 && best.score != 1) cancel = true;
+            if (best.score < 0 || r.score < best.score ||
+                (r.score == best.score && r.chain < best.chain))
+                best = r;
+        }
+    };
+    vector<thread> threads;
+    for (int id = 0; id < num_threads; ++id) threads.emplace_back(worker);
+    for (thread& th : threads) th.join();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 最終問題を出力
+    cout << "chain " << best.chain << " (seed " << seed << "): " << best.score
+         << " sols after " << best.iterations << " iterations" << endl;
+    cout << "chains started: " << min(next_chain.load(), num_chains)
+         << ", time: " << sec << " sec" << endl;
+    cout << "final problem: " << endl;
+    print(best.board);
+}
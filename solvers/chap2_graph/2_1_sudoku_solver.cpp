@@ -1,7 +1,13 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <set>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <chrono>
 using namespace std;
 
 // 盤面を二次元ベクトルで表す
@@ -12,9 +18,17 @@ class Sudoku {
  private:
     Field field_;
 
+    // 各行、各列、各ブロックに含まれる数字の集合 (数字 val をビット val で表す)
+    int row_[9], col_[9], box_[9];
+
+    // マス (x, y) を含むブロックの番号
+    static int box_id(int x, int y) {
+        return x / 3 * 3 + y / 3;
+    }
+
  public:
     // コンストラクタ (未確定マスの値を -1 で表す)
-    Sudoku() : field_(9, vector<int>(9, -1)) {
+    Sudoku() : field_(9, vector<int>(9, -1)), row_(), col_(), box_() {
     }
 
     // filed データを返す
@@ -25,11 +39,18 @@ class Sudoku {
     // マス (x, y) に数字 val を入れる
     void put(int x, int y, int val) {
         field_[x][y] = val;
+        row_[x] |= 1 << val;
+        col_[y] |= 1 << val;
+        box_[box_id(x, y)] |= 1 << val;
     }
 
     // マス (x, y) の数字を削除する
     void reset(int x, int y) {
+        int val = field_[x][y];
         field_[x][y] = -1;
+        row_[x] &= ~(1 << val);
+        col_[y] &= ~(1 << val);
+        box_[box_id(x, y)] &= ~(1 << val);
     }
 
     // 入力データを受け取る
@@ -50,11 +71,47 @@ class Sudoku {
         }
     }
 
+    // 1 行 81 文字の盤面を受け取る ('1' 〜 '9' 以外は空きマスとする)
+    // 81 文字に満たない場合や、同じ行、列、ブロックに同じ数字がある場合は false を返す
+    bool input(const string& line) {
+        if (line.size() < 81) return false;
+        for (int x = 0; x < 9; ++x) {
+            for (int y = 0; y < 9; ++y) {
+                char c = line[x * 9 + y];
+                if (c < '1' || c > '9') continue;
+                if (!(find_choices(x, y) >> (c - '0') & 1)) return false;
+                put(x, y, c - '0');
+            }
+        }
+        return true;
+    }
+
     // 空きマスを探索する (存在しない場合は false を返す)
     bool find_empty(int& x, int& y);
 
-    // マス (x, y) に入れられる数字の集合を返す
-    vector<int> find_choices(int x, int y);
+    // 入れられる数字が最も少ない空きマスを探索する (存在しない場合は false を返す)
+    bool find_most_constrained(int& x, int& y);
+
+    // 入れられる数字が 1 つに決まるマスに、数字を入れることを繰り返す
+    //   naked single: 入れられる数字が 1 つしかないマス
+    //   hidden single: 行、列、ブロックの中で、ある数字を入れられる唯一のマス
+    // 数字を入れたマスを trail に追加する (矛盾が見つかった場合は false を返す)
+    bool propagate(vector<pair<int, int>>& trail);
+
+    // trail に記録したマスのうち、先頭から size 個より後のマスの数字を削除する
+    void undo(vector<pair<int, int>>& trail, int size) {
+        while ((int)trail.size() > size) {
+            reset(trail.back().first, trail.back().second);
+            trail.pop_back();
+        }
+    }
+
+    // マス (x, y) に入れられる数字の集合を返す (数字 val をビット val で表す)
+    int find_choices(int x, int y) const {
+        // 同じ行、列、ブロックのいずれにも含まれない数字
+        const int ALL = 0x3FE;  // 数字 1 〜 9 の集合
+        return ALL & ~(row_[x] | col_[y] | box_[box_id(x, y)]);
+    }
 };
 
 // 空きマスを探索する (存在しない場合は false を返す)
@@ -66,34 +123,84 @@ bool Sudoku::find_empty(int& x, int& y) {
     return false;
 }
 
-// マス (x, y) に入れられる数字の集合を返す
-vector<int> Sudoku::find_choices(int x, int y) {
-    // マス (x, y) と同じ行、列、ブロックにある数字を求める
-    set<int> cannot_use;
-
-    // 同じ行に含まれる数字を除外する
-    for (int i = 0; i < 9; ++i)
-        if (field_[x][i] != -1)
-            cannot_use.insert(field_[x][i]);
-
-    // 同じ列に含まれる数字を除外する
-    for (int i = 0; i < 9; ++i)
-        if (field_[i][y] != -1)
-            cannot_use.insert(field_[i][y]);
-
-    // 同じブロックに含まれる数字を除外する
-    int x2 = x / 3 * 3, y2 = y / 3 * 3;  // 同じブロックの左上のマス
-    for (int i = x2; i < x2 + 3; ++i)
-        for (int j = y2; j < y2 + 3; ++j)
-            if (field_[i][j] != -1)
-                cannot_use.insert(field_[i][j]);
-
-    // マス (x, y) に入れられる数字からなる配列を求める
-    vector<int> res;
-    for (int val = 1; val <= 9; ++val)
-        if (!cannot_use.count(val))
-            res.push_back(val);
-    return res;
+// 入れられる数字が最も少ない空きマスを探索する (存在しない場合は false を返す)
+bool Sudoku::find_most_constrained(int& x, int& y) {
+    int min_num = 10;
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            if (field_[i][j] != -1) continue;
+            int num = __builtin_popcount(find_choices(i, j));
+            if (num < min_num) {
+                min_num = num, x = i, y = j;
+                if (num <= 1) return true;
+            }
+        }
+    }
+    return min_num < 10;
+}
+
+// 入れられる数字が 1 つに決まるマスに、数字を入れることを繰り返す
+bool Sudoku::propagate(vector<pair<int, int>>& trail) {
+    const int ALL = 0x3FE;  // 数字 1 〜 9 の集合
+    bool updated = true;
+    while (updated) {
+        updated = false;
+
+        // naked single: 入れられる数字が 1 つしかないマス
+        for (int x = 0; x < 9; ++x) {
+            for (int y = 0; y < 9; ++y) {
+                if (field_[x][y] != -1) continue;
+                int choices = find_choices(x, y);
+                if (choices == 0) return false;
+                if (choices & (choices - 1)) continue;
+                put(x, y, __builtin_ctz(choices));
+                trail.emplace_back(x, y);
+                updated = true;
+            }
+        }
+
+        // hidden single: 行、列、ブロック (unit = 0, 1, 2) の中で、
+        // ある数字を入れられるマスが 1 つしかない場合は、そのマスに入れる
+        for (int unit = 0; unit < 3; ++unit) {
+            for (int id = 0; id < 9; ++id) {
+                // once: 入れられるマスが 1 つ以上ある数字
+                // twice: 入れられるマスが 2 つ以上ある数字
+                int once = 0, twice = 0, used = 0;
+                for (int k = 0; k < 9; ++k) {
+                    int x = (unit == 0 ? id : unit == 1 ? k : id / 3 * 3 + k / 3);
+                    int y = (unit == 0 ? k : unit == 1 ? id : id % 3 * 3 + k % 3);
+                    if (field_[x][y] != -1) {
+                        used |= 1 << field_[x][y];
+                        continue;
+                    }
+                    int choices = find_choices(x, y);
+                    twice |= once & choices;
+                    once |= choices;
+                }
+
+                // どのマスにも入れられない数字があれば矛盾
+                if ((once | used) != ALL) return false;
+
+                // 入れられるマスが 1 つしかない数字を入れる
+                int single = once & ~twice;
+                if (single == 0) continue;
+                for (int k = 0; k < 9; ++k) {
+                    int x = (unit == 0 ? id : unit == 1 ? k : id / 3 * 3 + k / 3);
+                    int y = (unit == 0 ? k : unit == 1 ? id : id % 3 * 3 + k % 3);
+                    if (field_[x][y] != -1) continue;
+                    int choices = find_choices(x, y) & single;
+                    if (choices == 0) continue;
+
+                    // 1 つのマスに 2 つの数字を入れる必要がある場合は矛盾
+                    if (choices & (choices - 1)) return false;
+                    put(x, y, __builtin_ctz(choices));
+                    trail.emplace_back(x, y);
+                    updated = true;
+                }
+            }
+        }
+    }
+    return true;
 }
 
 // 数独を解くための再帰関数
@@ -110,42 +217,195 @@ void dfs(Sudoku& board, vector<Field>& res, bool all = true) {
     }
 
     // マス (x, y) に入れられる数字の集合を求める
-    const vector<int>& can_use = board.find_choices(x, y);
+    int can_use = board.find_choices(x, y);
 
-    // 空きマス (x, y) に数字を順に入れていく
-    for (int val : can_use) {
+    // 空きマス (x, y) に数字を小さい順に入れていく
+    for (; can_use; can_use &= can_use - 1) {
+        int val = __builtin_ctz(can_use);  // 集合に含まれる最小の数字
         board.put(x, y, val);  // マス (x, y) に数字 val を入れる
         dfs(board, res, all);  // 再帰呼び出し
         board.reset(x, y);  // マス (x, y) の数字を削除
     }
 }
 
-// 数独を解く
-vector<Field> solve(Sudoku& board, bool all = true) {
+// 数独を解くための再帰関数 (候補の少ないマスから埋め、確定するマスを先に埋める)
+void dfs_mrv(Sudoku& board, vector<Field>& res, bool all = true) {
+    // フラグ all が false のときは、解を 1 個求めたら抜ける
+    if (!all && !res.empty()) return;
+
+    // 数字が 1 つに決まるマスを埋める (矛盾した場合は元に戻して抜ける)
+    vector<pair<int, int>> trail;
+    if (!board.propagate(trail)) {
+        board.undo(trail, 0);
+        return;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探す (存在しない場合は終端条件)
+    int x, y;
+    if (!board.find_most_constrained(x, y)) {
+        // 解に追加
+        res.push_back(board.get());
+    } else {
+        // 空きマス (x, y) に数字を小さい順に入れていく
+        for (int can_use = board.find_choices(x, y); can_use; can_use &= can_use - 1) {
+            board.put(x, y, __builtin_ctz(can_use));  // マス (x, y) に数字を入れる
+            dfs_mrv(board, res, all);  // 再帰呼び出し
+            board.reset(x, y);  // マス (x, y) の数字を削除
+        }
+    }
+
+    // 埋めたマスを元に戻す
+    board.undo(trail, 0);
+}
+
+// 数独の解の個数を数えるための再帰関数 (盤面は複製せずに個数だけを数える)
+// num が limit に達したら打ち切る (limit が 0 のときは上限なし)
+// mrv が false のときは、dfs と同じく空きマスを左上から順に埋める
+void dfs_count(Sudoku& board, int64_t& num, int64_t limit, bool mrv = true) {
+    if (limit > 0 && num >= limit) return;
+
+    // 数字が 1 つに決まるマスを埋める (矛盾した場合は元に戻して抜ける)
+    vector<pair<int, int>> trail;
+    if (mrv && !board.propagate(trail)) {
+        board.undo(trail, 0);
+        return;
+    }
+
+    // 次に埋める空きマスを探す (存在しない場合は終端条件)
+    int x, y;
+    bool found = mrv ? board.find_most_constrained(x, y) : board.find_empty(x, y);
+    if (!found) {
+        ++num;
+    } else {
+        for (int can_use = board.find_choices(x, y); can_use; can_use &= can_use - 1) {
+            board.put(x, y, __builtin_ctz(can_use));
+            dfs_count(board, num, limit, mrv);
+            board.reset(x, y);
+        }
+    }
+    board.undo(trail, 0);
+}
+
+// 数独の解の個数を数える (limit 個に達した時点で打ち切る)
+// mrv が false のときは、空きマスを左上から順に埋める
+int64_t count(Sudoku& board, int64_t limit = 0, bool mrv = true) {
+    int64_t num = 0;
+    dfs_count(board, num, limit, mrv);
+    return num;
+}
+
+// 数独を解く (mrv が false のときは、空きマスを左上から順に埋める)
+vector<Field> solve(Sudoku& board, bool all = true, bool mrv = true) {
     // 答えを格納した配列
     vector<Field> res;
 
     // 再帰関数を呼び出す
-    dfs(board, res, all);
+    if (mrv) dfs_mrv(board, res, all);
+    else dfs(board, res, all);
     return res;
 }
 
-int main() {
+// 1 行 81 文字の盤面を連続して読み込み、複数のスレッドで解く
+// 解は入力の順に 1 行 81 文字で出力し (解がない場合は "No solutions.")、
+// 最後に処理速度と 1 問あたりの処理時間の分布を標準エラー出力に出力する
+void solve_bulk(istream& in, int num_threads) {
+    const int BATCH = 10000;  // 一度に読み込んで並列に解く問題数
+    vector<double> latencies;  // 各問題の処理時間 (マイクロ秒)
+    auto start = chrono::steady_clock::now();
+    while (true) {
+        // 問題を読み込む (空行は読み飛ばす)
+        vector<string> lines;
+        string line;
+        while ((int)lines.size() < BATCH && getline(in, line))
+            if (!line.empty()) lines.push_back(line);
+        if (lines.empty()) break;
+
+        // 各スレッドは未処理の問題を順に取り出し、自分の盤面を用いて解く
+        vector<string> answers(lines.size());
+        vector<double> times(lines.size());
+        atomic<size_t> next(0);
+        auto worker = [&]() -> void {
+            while (true) {
+                size_t i = next.fetch_add(1);
+                if (i >= lines.size()) break;
+                auto begin = chrono::steady_clock::now();
+                Sudoku board;
+                vector<Field> res;
+                if (board.input(lines[i])) res = solve(board, false);
+                if (res.empty()) {
+                    answers[i] = "No solutions.";
+                } else {
+                    for (int x = 0; x < 9; ++x)
+                        for (int y = 0; y < 9; ++y)
+                            answers[i] += char('0' + res[0][x][y]);
+                }
+                times[i] = chrono::duration<double, micro>(
+                    chrono::steady_clock::now() - begin).count();
+            }
+        };
+        vector<thread> threads;
+        for (int id = 0; id < num_threads; ++id) threads.emplace_back(worker);
+        for (thread& th : threads) th.join();
+
+        // 入力の順に出力する
+        for (const string& answer : answers) cout << answer << '\n';
+        latencies.insert(latencies.end(), times.begin(), times.end());
+    }
+    cout << flush;
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 処理速度と、処理時間のパーセンタイルを出力する
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) -> double {
+        if (latencies.empty()) return 0;
+        return latencies[min(latencies.size() - 1, (size_t)(p / 100 * latencies.size()))];
+    };
+    cerr << "puzzles: " << latencies.size() << ", threads: " << num_threads
+         << ", time: " << sec << " sec, " << latencies.size() / sec << " puzzles/sec" << endl;
+    cerr << "latency (us): p50 " << percentile(50) << ", p90 " << percentile(90)
+         << ", p99 " << percentile(99) << ", p99.9 " << percentile(99.9)
+         << ", max " << percentile(100) << endl;
+}
+
+int main(int argc, char** argv) {
+    // 使い方:
+    //   sudoku_solver [--naive]: 9 行の盤面を 1 つ入力して解く
+    //     (--naive が指定された場合は、解の個数を数えるときも解を求めるときも、
+    //      空きマスを左上から順に埋める)
+    //   sudoku_solver --bulk [file] [threads]: 1 行 81 文字の盤面を連続して解く
+    //     (file を省略するか "-" とした場合は標準入力から読み込む)
+    if (argc >= 2 && string(argv[1]) == "--bulk") {
+        int num_threads = argc >= 4 ? stoi(argv[3]) : thread::hardware_concurrency();
+        if (num_threads <= 0) num_threads = 1;
+        if (argc >= 3 && string(argv[2]) != "-") {
+            ifstream file(argv[2]);
+            if (!file) {
+                cerr << "cannot open " << argv[2] << endl;
+                return 1;
+            }
+            solve_bulk(file, num_threads);
+        } else {
+            solve_bulk(cin, num_threads);
+        }
+        return 0;
+    }
+    bool mrv = !(argc >= 2 && string(argv[1]) == "--naive");
+
     // 数独を入力する
     cout << "Sudoku Input: " << endl;
     Sudoku board;
     board.input();
 
-    // 数独を解く
-    vector<Field> res = solve(board);
+    // 解の個数を 2 個まで数えて、一意に解ける場合のみ解を求める
+    int64_t num = count(board, 2, mrv);
 
     // 解を出力する
-    if (res.size() == 0) {
+    if (num == 0) {
         cout << "No solutions." << endl;
-    } else if (res.size() > 1) {
+    } else if (num > 1) {
         cout << "More than one solution." << endl;
     } else {
-        const Field& answer = res[0];
+        Field answer = solve(board, false, mrv)[0];
         for (int x = 0; x < 9; ++x) {
             for (int y = 0; y < 9; ++y)
                 cout << answer[x][y] << " ";
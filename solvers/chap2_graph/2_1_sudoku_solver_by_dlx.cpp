@@ -0,0 +1,243 @@
+#include <iostream>
+#include <vector>
+#include <string>
+using namespace std;
+
+// 完全被覆問題を Dancing Links で解くクラス (Knuth の Algorithm X)
+// 列 (満たすべき条件) と行 (選択肢と、それが満たす条件の集合) を与えると、
+// どの列もちょうど 1 つの行で満たされるような行の選び方を求める
+class ExactCover {
+ private:
+    // ノード i の上下左右のノード、属する列 (列ヘッダは 1, ..., num_cols、0 は根)
+    vector<int> left_, right_, up_, down_, col_;
+
+    // ノード i が属する行の番号
+    vector<int> row_;
+
+    // 各列に残っているノードの個数
+    vector<int> size_;
+
+    // 選んだ行の番号と、見つかった解
+    vector<int> chosen_;
+    vector<vector<int>> res_;
+    int limit_ = 0;
+
+    // 列 c とそれを満たす行を取り除く
+    void cover(int c) {
+        right_[left_[c]] = right_[c], left_[right_[c]] = left_[c];
+        for (int i = down_[c]; i != c; i = down_[i]) {
+            for (int j = right_[i]; j != i; j = right_[j]) {
+                down_[up_[j]] = down_[j], up_[down_[j]] = up_[j];
+                --size_[col_[j]];
+            }
+        }
+    }
+
+    // cover(c) で取り除いたものを元に戻す (取り除いたときと逆の順に戻す)
+    void uncover(int c) {
+        for (int i = up_[c]; i != c; i = up_[i]) {
+            for (int j = left_[i]; j != i; j = left_[j]) {
+                ++size_[col_[j]];
+                down_[up_[j]] = j, up_[down_[j]] = j;
+            }
+        }
+        right_[left_[c]] = c, left_[right_[c]] = c;
+    }
+
+    // 再帰関数: 満たす行が最も少ない列を選び、その列を満たす行を順に試す
+    void search() {
+        if (limit_ > 0 && (int)res_.size() >= limit_) return;
+
+        // すべての列が満たされた
+        if (right_[0] == 0) {
+            res_.push_back(chosen_);
+            return;
+        }
+
+        // 満たす行が最も少ない列を選ぶ
+        int c = right_[0];
+        for (int j = right_[c]; j != 0; j = right_[j])
+            if (size_[j] < size_[c]) c = j;
+        if (size_[c] == 0) return;
+
+        cover(c);
+        for (int i = down_[c]; i != c; i = down_[i]) {
+            chosen_.push_back(row_[i]);
+            for (int j = right_[i]; j != i; j = right_[j]) cover(col_[j]);
+            search();
+            for (int j = left_[i]; j != i; j = left_[j]) uncover(col_[j]);
+            chosen_.pop_back();
+        }
+        uncover(c);
+    }
+
+ public:
+    // コンストラクタ (列の個数を指定する)
+    ExactCover(int num_cols) : size_(num_cols + 1, 0) {
+        for (int c = 0; c <= num_cols; ++c) {
+            left_.push_back(c == 0 ? num_cols : c - 1);
+            right_.push_back(c == num_cols ? 0 : c + 1);
+            up_.push_back(c), down_.push_back(c);
+            col_.push_back(c), row_.push_back(-1);
+        }
+    }
+
+    // 列の集合 cols (1 始まり) を満たす行を、番号 id として追加する
+    void add_row(int id, const vector<int>& cols) {
+        int first = left_.size();
+        for (int k = 0; k < (int)cols.size(); ++k) {
+            int c = cols[k], node = left_.size();
+
+            // 列 c の末尾に挿入する
+            up_.push_back(up_[c]), down_.push_back(c);
+            down_[up_[c]] = node, up_[c] = node;
+
+            // 行の中で左右につなぐ (環状にする)
+            left_.push_back(k == 0 ? node : node - 1);
+            right_.push_back(first);
+            if (k > 0) right_[node - 1] = node;
+            left_[first] = node;
+
+            col_.push_back(c), row_.push_back(id);
+            ++size_[c];
+        }
+    }
+
+    // 解を求める (limit 個見つかった時点で打ち切る、0 のときは上限なし)
+    // 各解は選んだ行の番号の配列で表す
+    vector<vector<int>> solve(int limit = 0) {
+        res_.clear(), chosen_.clear();
+        limit_ = limit;
+        search();
+        return res_;
+    }
+};
+
+// 盤面の数字を表す記号 (空きマスは '*')
+const string SYMBOLS = "123456789ABCDEFGHIJKLMNOP";
+
+// 数独を完全被覆問題に帰着して解くクラス (ブロックの大きさ B をコンパイル時に指定する)
+// 行: 「マス (x, y) に数字 v を入れる」という選択肢 (N^3 通り)
+// 列: 「マス (x, y) に数字が入る」「行 x に数字 v が入る」「列 y に数字 v が入る」
+//     「ブロック b に数字 v が入る」という条件 (4 N^2 通り)
+template<int B> class SudokuDLX {
+ public:
+    static constexpr int N = B * B;  // 盤面の大きさ
+
+    // 盤面 (未確定マスの値を -1、数字を 0, ..., N - 1 で表す)
+    using Field = vector<vector<int>>;
+
+ private:
+    Field field_;
+
+ public:
+    // コンストラクタ
+    SudokuDLX(const Field& field) : field_(field) { }
+
+    // 数独を解く (limit 個見つかった時点で打ち切る)
+    vector<Field> solve(int limit = 2) const {
+        // 各行、列、ブロックにすでに入っている数字を求める
+        vector<vector<bool>> in_row(N, vector<bool>(N, false));
+        vector<vector<bool>> in_col = in_row, in_box = in_row;
+        for (int x = 0; x < N; ++x) {
+            for (int y = 0; y < N; ++y) {
+                int v = field_[x][y];
+                if (v == -1) continue;
+                in_row[x][v] = in_col[y][v] = in_box[x / B * B + y / B][v] = true;
+            }
+        }
+
+        // 与えられた数字と矛盾しない選択肢だけを行として追加する
+        ExactCover dlx(4 * N * N);
+        for (int x = 0; x < N; ++x) {
+            for (int y = 0; y < N; ++y) {
+                int b = x / B * B + y / B;
+                for (int v = 0; v < N; ++v) {
+                    if (field_[x][y] != -1 && field_[x][y] != v) continue;
+                    if (field_[x][y] == -1 && (in_row[x][v] || in_col[y][v] || in_box[b][v]))
+                        continue;
+                    dlx.add_row((x * N + y) * N + v,
+                                {1 + x * N + y, 1 + N * N + x * N + v,
+                                 1 + 2 * N * N + y * N + v, 1 + 3 * N * N + b * N + v});
+                }
+            }
+        }
+
+        // 選んだ行から盤面を復元する
+        vector<Field> res;
+        for (const vector<int>& rows : dlx.solve(limit)) {
+            Field answer(N, vector<int>(N, -1));
+            for (int id : rows) answer[id / N / N][id / N % N] = id % N;
+            res.push_back(answer);
+        }
+        return res;
+    }
+};
+
+// ブロックの大きさ B の数独を入力して解く
+template<int B> void run(const vector<string>& lines) {
+    const int N = SudokuDLX<B>::N;
+
+    // 盤面は N 行 N 列でなければならない
+    if ((int)lines.size() != N) {
+        cout << "Invalid input: expected " << N << " rows" << endl;
+        return;
+    }
+    for (int x = 0; x < N; ++x) {
+        if ((int)lines[x].size() != N) {
+            cout << "Invalid input: row " << x + 1 << " must have " << N
+                 << " characters" << endl;
+            return;
+        }
+    }
+
+    // 記号を数字に変換する
+    // ('*' は空きマス、それ以外は先頭の N 個の記号のいずれかでなければならない)
+    typename SudokuDLX<B>::Field field(N, vector<int>(N, -1));
+    for (int x = 0; x < N; ++x) {
+        for (int y = 0; y < N; ++y) {
+            if (lines[x][y] == '*') continue;
+            size_t v = SYMBOLS.find(lines[x][y]);
+            if (v == string::npos || (int)v >= N) {
+                cout << "Invalid input: unknown symbol '" << lines[x][y] << "' in row "
+                     << x + 1 << endl;
+                return;
+            }
+            field[x][y] = v;
+        }
+    }
+
+    // 数独を解く (一意性を判定するため、解を 2 個まで求める)
+    SudokuDLX<B> sudoku(field);
+    auto res = sudoku.solve(2);
+
+    // 解を出力する
+    if (res.size() == 0) {
+        cout << "No solutions." << endl;
+    } else if (res.size() > 1) {
+        cout << "More than one solution." << endl;
+    } else {
+        for (int x = 0; x < N; ++x) {
+            for (int y = 0; y < N; ++y)
+                cout << SYMBOLS[res[0][x][y]] << " ";
+            cout << endl;
+        }
+    }
+}
+
+int main() {
+    // 数独を入力する (1 行めの長さから盤面の大きさ 9, 16, 25 を判定する)
+    cout << "Sudoku Input: " << endl;
+    vector<string> lines;
+    string line;
+    cin >> line;
+    int n = line.size();
+    lines.push_back(line);
+    for (int x = 1; x < n && cin >> line; ++x) lines.push_back(line);
+
+    // 盤面の大きさに応じたブロックの大きさで解く
+    if (n == 9) run<3>(lines);
+    else if (n == 16) run<4>(lines);
+    else if (n == 25) run<5>(lines);
+    else cout << "Unsupported size: " << n << endl;
+}
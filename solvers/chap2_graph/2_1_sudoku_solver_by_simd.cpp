@@ -0,0 +1,442 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+#include <chrono>
+using namespace std;
+
+// 盤面を二次元ベクトルで表す
+using Field = vector<vector<int>>;
+
+// 数独を解くためのクラス
+class Sudoku {
+ private:
+    Field field_;
+
+    // 各行、各列、各ブロックに含まれる数字の集合 (数字 val をビット val で表す)
+    int row_[9], col_[9], box_[9];
+
+    // マス (x, y) を含むブロックの番号
+    static int box_id(int x, int y) {
+        return x / 3 * 3 + y / 3;
+    }
+
+ public:
+    // コンストラクタ (未確定マスの値を -1 で表す)
+    Sudoku() : field_(9, vector<int>(9, -1)), row_(), col_(), box_() {
+    }
+
+    // filed データを返す
+    const Field& get() {
+        return field_;
+    }
+
+    // マス (x, y) に数字 val を入れる
+    void put(int x, int y, int val) {
+        field_[x][y] = val;
+        row_[x] |= 1 << val;
+        col_[y] |= 1 << val;
+        box_[box_id(x, y)] |= 1 << val;
+    }
+
+    // マス (x, y) の数字を削除する
+    void reset(int x, int y) {
+        int val = field_[x][y];
+        field_[x][y] = -1;
+        row_[x] &= ~(1 << val);
+        col_[y] &= ~(1 << val);
+        box_[box_id(x, y)] &= ~(1 << val);
+    }
+
+    // 1 行 81 文字の盤面を受け取る ('1' 〜 '9' 以外は空きマスとする)
+    // 81 文字に満たない場合や、同じ行、列、ブロックに同じ数字がある場合は false を返す
+    bool input(const string& line) {
+        if (line.size() < 81) return false;
+        for (int x = 0; x < 9; ++x) {
+            for (int y = 0; y < 9; ++y) {
+                char c = line[x * 9 + y];
+                if (c < '1' || c > '9') continue;
+                if (!(find_choices(x, y) >> (c - '0') & 1)) return false;
+                put(x, y, c - '0');
+            }
+        }
+        return true;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探索する (存在しない場合は false を返す)
+    bool find_most_constrained(int& x, int& y);
+
+    // 入れられる数字が 1 つに決まるマスに、数字を入れることを繰り返す
+    //   naked single: 入れられる数字が 1 つしかないマス
+    //   hidden single: 行、列、ブロックの中で、ある数字を入れられる唯一のマス
+    // 数字を入れたマスを trail に追加する (矛盾が見つかった場合は false を返す)
+    bool propagate(vector<pair<int, int>>& trail);
+
+    // trail に記録したマスのうち、先頭から size 個より後のマスの数字を削除する
+    void undo(vector<pair<int, int>>& trail, int size) {
+        while ((int)trail.size() > size) {
+            reset(trail.back().first, trail.back().second);
+            trail.pop_back();
+        }
+    }
+
+    // マス (x, y) に入れられる数字の集合を返す (数字 val をビット val で表す)
+    int find_choices(int x, int y) const {
+        // 同じ行、列、ブロックのいずれにも含まれない数字
+        const int ALL = 0x3FE;  // 数字 1 〜 9 の集合
+        return ALL & ~(row_[x] | col_[y] | box_[box_id(x, y)]);
+    }
+};
+
+// 入れられる数字が最も少ない空きマスを探索する (存在しない場合は false を返す)
+bool Sudoku::find_most_constrained(int& x, int& y) {
+    int min_num = 10;
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            if (field_[i][j] != -1) continue;
+            int num = __builtin_popcount(find_choices(i, j));
+            if (num < min_num) {
+                min_num = num, x = i, y = j;
+                if (num <= 1) return true;
+            }
+        }
+    }
+    return min_num < 10;
+}
+
+// 入れられる数字が 1 つに決まるマスに、数字を入れることを繰り返す
+bool Sudoku::propagate(vector<pair<int, int>>& trail) {
+    const int ALL = 0x3FE;  // 数字 1 〜 9 の集合
+    bool updated = true;
+    while (updated) {
+        updated = false;
+
+        // naked single: 入れられる数字が 1 つしかないマス
+        for (int x = 0; x < 9; ++x) {
+            for (int y = 0; y < 9; ++y) {
+                if (field_[x][y] != -1) continue;
+                int choices = find_choices(x, y);
+                if (choices == 0) return false;
+                if (choices & (choices - 1)) continue;
+                put(x, y, __builtin_ctz(choices));
+                trail.emplace_back(x, y);
+                updated = true;
+            }
+        }
+
+        // hidden single: 行、列、ブロック (unit = 0, 1, 2) の中で、
+        // ある数字を入れられるマスが 1 つしかない場合は、そのマスに入れる
+        for (int unit = 0; unit < 3; ++unit) {
+            for (int id = 0; id < 9; ++id) {
+                // once: 入れられるマスが 1 つ以上ある数字
+                // twice: 入れられるマスが 2 つ以上ある数字
+                int once = 0, twice = 0, used = 0;
+                for (int k = 0; k < 9; ++k) {
+                    int x = (unit == 0 ? id : unit == 1 ? k : id / 3 * 3 + k / 3);
+                    int y = (unit == 0 ? k : unit == 1 ? id : id % 3 * 3 + k % 3);
+                    if (field_[x][y] != -1) {
+                        used |= 1 << field_[x][y];
+                        continue;
+                    }
+                    int choices = find_choices(x, y);
+                    twice |= once & choices;
+                    once |= choices;
+                }
+
+                // どのマスにも入れられない数字があれば矛盾
+                if ((once | used) != ALL) return false;
+
+                // 入れられるマスが 1 つしかない数字を入れる
+                int single = once & ~twice;
+                if (single == 0) continue;
+                for (int k = 0; k < 9; ++k) {
+                    int x = (unit == 0 ? id : unit == 1 ? k : id / 3 * 3 + k / 3);
+                    int y = (unit == 0 ? k : unit == 1 ? id : id % 3 * 3 + k % 3);
+                    if (field_[x][y] != -1) continue;
+                    int choices = find_choices(x, y) & single;
+                    if (choices == 0) continue;
+
+                    // 1 つのマスに 2 つの数字を入れる必要がある場合は矛盾
+                    if (choices & (choices - 1)) return false;
+                    put(x, y, __builtin_ctz(choices));
+                    trail.emplace_back(x, y);
+                    updated = true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// 数独を解くための再帰関数 (候補の少ないマスから埋め、確定するマスを先に埋める)
+void dfs_mrv(Sudoku& board, vector<Field>& res, bool all = true) {
+    // フラグ all が false のときは、解を 1 個求めたら抜ける
+    if (!all && !res.empty()) return;
+
+    // 数字が 1 つに決まるマスを埋める (矛盾した場合は元に戻して抜ける)
+    vector<pair<int, int>> trail;
+    if (!board.propagate(trail)) {
+        board.undo(trail, 0);
+        return;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探す (存在しない場合は終端条件)
+    int x, y;
+    if (!board.find_most_constrained(x, y)) {
+        // 解に追加
+        res.push_back(board.get());
+    } else {
+        // 空きマス (x, y) に数字を小さい順に入れていく
+        for (int can_use = board.find_choices(x, y); can_use; can_use &= can_use - 1) {
+            board.put(x, y, __builtin_ctz(can_use));  // マス (x, y) に数字を入れる
+            dfs_mrv(board, res, all);  // 再帰呼び出し
+            board.reset(x, y);  // マス (x, y) の数字を削除
+        }
+    }
+
+    // 埋めたマスを元に戻す
+    board.undo(trail, 0);
+}
+
+// 複数の問題をまとめて扱うレーン数
+// 各レーンの候補集合を 16 ビットで表すので、16 レーンで 256 ビットのレジスタ 1 本分になる
+const int LANES = 16;
+
+// マス (x, y) を含む行、列、ブロックの番号
+inline int box_of(int cell) {
+    return cell / 27 * 3 + cell % 9 / 3;
+}
+
+// ユニット (行、列、ブロック) u に含まれる k 番めのマス
+inline int unit_cell(int u, int k) {
+    if (u < 9) return u * 9 + k;
+    if (u < 18) return k * 9 + (u - 9);
+    int b = u - 18;
+    return (b / 3 * 3 + k / 3) * 9 + b % 3 * 3 + k % 3;
+}
+
+// LANES 個の数独を 1 組として、候補の絞り込みをまとめて行うクラス
+// 各配列の最後の添字がレーン (問題) を表し、レーン方向のループは分岐を含まないので、
+// コンパイラの自動ベクトル化により SIMD 命令 (AVX2 / SSE) でまとめて処理される
+// (AVX2 を使うには -mavx2 や -march=native を付けてコンパイルする、
+//  対応する命令がない環境では、そのまま通常の命令で実行される)
+// 数字 val はビット val で表す (Sudoku クラスと同じ)
+class SudokuLanes {
+ private:
+    // 各マスに入っている数字 (空きマスは 0)
+    alignas(32) uint16_t cell_[81][LANES];
+
+    // 各行、各列、各ブロックに含まれる数字の集合
+    alignas(32) uint16_t row_[9][LANES], col_[9][LANES], box_[9][LANES];
+
+    // 矛盾が見つかったレーン (0xFFFF) とそれ以外 (0)
+    alignas(32) uint16_t dead_[LANES];
+
+    // マス cell に、レーンごとに数字の集合 put (1 ビットまたは 0) を入れる
+    void place(int cell, const uint16_t* put) {
+        uint16_t* r = row_[cell / 9];
+        uint16_t* c = col_[cell % 9];
+        uint16_t* b = box_[box_of(cell)];
+        for (int l = 0; l < LANES; ++l) {
+            cell_[cell][l] |= put[l];
+            r[l] |= put[l], c[l] |= put[l], b[l] |= put[l];
+        }
+    }
+
+ public:
+    // num 個の 81 文字の盤面を読み込む (残りのレーンは矛盾したものとして扱う)
+    void load(const string* lines, int num) {
+        for (int i = 0; i < 81; ++i)
+            for (int l = 0; l < LANES; ++l) cell_[i][l] = 0;
+        for (int i = 0; i < 9; ++i)
+            for (int l = 0; l < LANES; ++l) row_[i][l] = col_[i][l] = box_[i][l] = 0;
+        for (int l = 0; l < LANES; ++l) {
+            dead_[l] = (l < num ? 0 : 0xFFFF);
+            if (l >= num) continue;
+            Sudoku board;
+            if (!board.input(lines[l])) {
+                dead_[l] = 0xFFFF;
+                continue;
+            }
+            for (int i = 0; i < 81; ++i) {
+                char ch = lines[l][i];
+                if (ch < '1' || ch > '9') continue;
+                uint16_t v = 1 << (ch - '0');
+                cell_[i][l] = v;
+                row_[i / 9][l] |= v, col_[i % 9][l] |= v, box_[box_of(i)][l] |= v;
+            }
+        }
+    }
+
+    // naked single と hidden single を、すべてのレーンで変化がなくなるまで繰り返す
+    void propagate() {
+        const uint16_t ALL = 0x3FE;  // 数字 1 〜 9 の集合
+        alignas(32) uint16_t cand[81][LANES];
+        alignas(32) uint16_t put[LANES];
+        bool updated = true;
+        while (updated) {
+            updated = false;
+            uint16_t changed = 0;
+
+            // naked single: 入れられる数字が 1 つしかない空きマスに入れる
+            for (int i = 0; i < 81; ++i) {
+                const uint16_t* r = row_[i / 9];
+                const uint16_t* c = col_[i % 9];
+                const uint16_t* b = box_[box_of(i)];
+                for (int l = 0; l < LANES; ++l) {
+                    uint16_t empty = (cell_[i][l] == 0 ? 0xFFFF : 0);
+                    uint16_t ch = ALL & ~(r[l] | c[l] | b[l]) & empty;
+                    uint16_t single = ((ch & (ch - 1)) == 0 ? 0xFFFF : 0);
+                    dead_[l] |= empty & (ch == 0 ? 0xFFFF : 0);
+                    put[l] = ch & single & ~dead_[l];
+                    changed |= put[l];
+                }
+                place(i, put);
+            }
+
+            // 各マスに入れられる数字の集合
+            for (int i = 0; i < 81; ++i) {
+                const uint16_t* r = row_[i / 9];
+                const uint16_t* c = col_[i % 9];
+                const uint16_t* b = box_[box_of(i)];
+                for (int l = 0; l < LANES; ++l) {
+                    uint16_t empty = (cell_[i][l] == 0 ? 0xFFFF : 0);
+                    cand[i][l] = ALL & ~(r[l] | c[l] | b[l]) & empty;
+                }
+            }
+
+            // hidden single: ユニットの中で、ある数字を入れられる唯一のマスに入れる
+            for (int u = 0; u < 27; ++u) {
+                alignas(32) uint16_t once[LANES] = {}, twice[LANES] = {}, used[LANES] = {};
+                for (int k = 0; k < 9; ++k) {
+                    int i = unit_cell(u, k);
+                    for (int l = 0; l < LANES; ++l) {
+                        twice[l] |= once[l] & cand[i][l];
+                        once[l] |= cand[i][l];
+                        used[l] |= cell_[i][l];
+                    }
+                }
+                for (int l = 0; l < LANES; ++l) {
+                    // どのマスにも入れられない数字があれば矛盾
+                    dead_[l] |= ((once[l] | used[l]) != ALL ? 0xFFFF : 0);
+                    once[l] &= ~twice[l];
+                }
+                for (int k = 0; k < 9; ++k) {
+                    int i = unit_cell(u, k);
+                    for (int l = 0; l < LANES; ++l) {
+                        // 同じ行、列、ブロックで先に入れた数字は除く
+                        uint16_t now = ~(row_[i / 9][l] | col_[i % 9][l] | box_[box_of(i)][l]);
+                        uint16_t p = cand[i][l] & once[l] & now;
+
+                        // 1 つのマスに 2 つの数字を入れる必要がある場合は矛盾
+                        dead_[l] |= ((p & (p - 1)) != 0 ? 0xFFFF : 0);
+                        put[l] = p & ~dead_[l];
+                        changed |= put[l];
+                    }
+                    place(i, put);
+                }
+            }
+            updated = (changed != 0);
+        }
+    }
+
+    // レーン l の状態 (0: 矛盾、1: 解けた、2: 未確定のマスが残る)
+    int status(int l) const {
+        if (dead_[l]) return 0;
+        for (int i = 0; i < 81; ++i)
+            if (cell_[i][l] == 0) return 2;
+        return 1;
+    }
+
+    // レーン l の盤面を 81 文字で返す (空きマスは '*')
+    string get(int l) const {
+        string res(81, '*');
+        for (int i = 0; i < 81; ++i)
+            if (cell_[i][l]) res[i] = char('0' + __builtin_ctz(cell_[i][l]));
+        return res;
+    }
+};
+
+// 1 行 81 文字の問題を Sudoku クラスで解き、解を 81 文字で返す
+string solve_scalar(const string& line) {
+    Sudoku board;
+    vector<Field> res;
+    if (board.input(line)) dfs_mrv(board, res, false);
+    if (res.empty()) return "No solutions.";
+    string answer;
+    for (int x = 0; x < 9; ++x)
+        for (int y = 0; y < 9; ++y) answer += char('0' + res[0][x][y]);
+    return answer;
+}
+
+// 問題を LANES 個ずつまとめて候補を絞り込み、解き切れなかったものは Sudoku クラスで解く
+vector<string> solve_lanes(const vector<string>& lines, int64_t& num_scalar) {
+    vector<string> res(lines.size());
+    SudokuLanes lanes;
+    num_scalar = 0;
+    for (size_t begin = 0; begin < lines.size(); begin += LANES) {
+        int num = min<size_t>(LANES, lines.size() - begin);
+        lanes.load(&lines[begin], num);
+        lanes.propagate();
+        for (int l = 0; l < num; ++l) {
+            int st = lanes.status(l);
+            if (st == 0) {
+                res[begin + l] = "No solutions.";
+            } else if (st == 1) {
+                res[begin + l] = lanes.get(l);
+            } else {
+                res[begin + l] = solve_scalar(lanes.get(l));
+                ++num_scalar;
+            }
+        }
+    }
+    return res;
+}
+
+int main(int argc, char** argv) {
+    // 使い方: sudoku_solver_by_simd [file]
+    // 1 行 81 文字の盤面を読み込み (file を省略した場合は標準入力)、解を入力の順に出力する
+    // 最後に、Sudoku クラスだけで解いた場合との処理速度の比較を標準エラー出力に出力する
+    vector<string> lines;
+    string line;
+    if (argc >= 2) {
+        ifstream file(argv[1]);
+        if (!file) {
+            cerr << "cannot open " << argv[1] << endl;
+            return 1;
+        }
+        while (getline(file, line))
+            if (!line.empty()) lines.push_back(line);
+    } else {
+        while (getline(cin, line))
+            if (!line.empty()) lines.push_back(line);
+    }
+
+    // レーンごとにまとめて解く
+    auto start = chrono::steady_clock::now();
+    int64_t num_scalar = 0;
+    vector<string> res = solve_lanes(lines, num_scalar);
+    double sec_lanes = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 比較のため、Sudoku クラスだけで解く
+    start = chrono::steady_clock::now();
+    vector<string> res_scalar;
+    for (const string& l : lines) res_scalar.push_back(solve_scalar(l));
+    double sec_scalar = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 解を出力する
+    for (const string& answer : res) cout << answer << '\n';
+    cout << flush;
+
+    // 処理速度を出力する (解が一意でない問題では、両者の解が異なることがある)
+    int64_t num_diff = 0;
+    for (size_t i = 0; i < res.size(); ++i) num_diff += (res[i] != res_scalar[i]);
+    cerr << "puzzles: " << lines.size() << ", lanes: " << LANES
+         << ", finished by scalar search: " << num_scalar << endl;
+    cerr << "lanes: " << sec_lanes << " sec, " << lines.size() / sec_lanes << " puzzles/sec" << endl;
+    cerr << "scalar: " << sec_scalar << " sec, " << lines.size() / sec_scalar << " puzzles/sec" << endl;
+    cerr << "different answers: " << num_diff << endl;
+}
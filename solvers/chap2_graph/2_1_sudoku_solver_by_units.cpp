@@ -0,0 +1,386 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+using namespace std;
+
+// 数字 1 〜 9 の集合 (数字 val をビット val で表す)
+const int ALL = 0x3FE;
+
+// 盤面のマスの番号 (マス (x, y) は x * 9 + y)
+inline int cell_id(int x, int y) {
+    return x * 9 + y;
+}
+
+// 制約を表すユニットの表
+// ユニットは「互いに異なる数字が入るマスの集合」で、sum が正の場合は
+// 「数字の和が sum になる」という制約も課す (キラー数独のケージ)
+// 変種の数独は、この表に加えるユニットの違いだけで表す
+struct Units {
+    vector<vector<int>> cells;
+    vector<int> sum;
+
+    // ユニットを追加する
+    void add(const vector<int>& unit_cells, int unit_sum = 0) {
+        cells.push_back(unit_cells);
+        sum.push_back(unit_sum);
+    }
+
+    // 通常の数独の行と列
+    void add_rows_and_columns() {
+        for (int i = 0; i < 9; ++i) {
+            vector<int> row, col;
+            for (int j = 0; j < 9; ++j) {
+                row.push_back(cell_id(i, j));
+                col.push_back(cell_id(j, i));
+            }
+            add(row), add(col);
+        }
+    }
+
+    // 通常の数独の 3 × 3 のブロック
+    void add_boxes() {
+        for (int b = 0; b < 9; ++b) {
+            vector<int> box;
+            for (int k = 0; k < 9; ++k)
+                box.push_back(cell_id(b / 3 * 3 + k / 3, b % 3 * 3 + k % 3));
+            add(box);
+        }
+    }
+
+    // ジグソー数独の不規則なブロック (regions[x][y] が同じマスが 1 つのブロック)
+    // 9 × 9 の文字からなり、9 種類の文字がそれぞれ 9 マスずつ現れなければ何もせず false を返す
+    bool add_regions(const vector<string>& regions) {
+        vector<char> ids;
+        for (const string& line : regions) {
+            if (line.size() != 9) return false;
+            for (char c : line)
+                if (find(ids.begin(), ids.end(), c) == ids.end()) ids.push_back(c);
+        }
+        if (ids.size() != 9) return false;
+        vector<vector<int>> blocks;
+        for (char id : ids) {
+            vector<int> region;
+            for (int x = 0; x < 9; ++x)
+                for (int y = 0; y < 9; ++y)
+                    if (regions[x][y] == id) region.push_back(cell_id(x, y));
+            if (region.size() != 9) return false;
+            blocks.push_back(region);
+        }
+        for (const vector<int>& region : blocks) add(region);
+        return true;
+    }
+
+    // 対角線数独の 2 本の対角線
+    void add_diagonals() {
+        vector<int> d1, d2;
+        for (int i = 0; i < 9; ++i) {
+            d1.push_back(cell_id(i, i));
+            d2.push_back(cell_id(i, 8 - i));
+        }
+        add(d1), add(d2);
+    }
+
+    // アンチナイト数独: 桂馬跳びの位置にある 2 マスを 1 つのユニットとする
+    void add_anti_knight() {
+        const int DX[4] = {1, 1, 2, 2}, DY[4] = {-2, 2, -1, 1};
+        for (int x = 0; x < 9; ++x) {
+            for (int y = 0; y < 9; ++y) {
+                for (int d = 0; d < 4; ++d) {
+                    int x2 = x + DX[d], y2 = y + DY[d];
+                    if (x2 < 0 || x2 >= 9 || y2 < 0 || y2 >= 9) continue;
+                    add({cell_id(x, y), cell_id(x2, y2)});
+                }
+            }
+        }
+    }
+};
+
+// CAGE_DIGITS[avail >> 1][k][s]: 集合 avail に含まれる互いに異なる k 個の数字で、
+// 和が s になる選び方に現れる数字の集合
+vector<array<array<uint16_t, 46>, 10>> build_cage_digits() {
+    vector<array<array<uint16_t, 46>, 10>> res(512);
+    for (auto& a : res)
+        for (auto& b : a) b.fill(0);
+    for (int avail = 0; avail < 512; ++avail) {
+        // avail の部分集合 sub をすべて調べる
+        for (int sub = avail; ; sub = (sub - 1) & avail) {
+            int s = 0;
+            for (int v = 1; v <= 9; ++v)
+                if (sub >> (v - 1) & 1) s += v;
+            res[avail][__builtin_popcount(sub)][s] |= sub << 1;
+            if (sub == 0) break;
+        }
+    }
+    return res;
+}
+const vector<array<array<uint16_t, 46>, 10>> CAGE_DIGITS = build_cage_digits();
+
+// ユニットの表に基づいて数独を解くクラス
+// 各マスに入れられる数字は、そのマスを含むユニットで使われた数字の集合
+// (ビットマスク) の和集合を除いたものとして求める
+class UnitSudoku {
+ private:
+    // ユニットの表と、各マスを含むユニットの番号
+    Units units_;
+    vector<vector<int>> cell_units_;
+
+    // 9 マスからなるユニット (すべての数字がちょうど 1 回ずつ入る)
+    vector<int> houses_;
+
+    // 各マスの数字 (空きマスは 0)
+    array<int, 81> field_;
+
+    // 各ユニットで使われた数字の集合、数字の和、空きマスの個数
+    vector<int> used_, placed_sum_, num_empty_;
+
+ public:
+    // コンストラクタ
+    UnitSudoku(const Units& units) : units_(units), cell_units_(81) {
+        int U = units_.cells.size();
+        for (int u = 0; u < U; ++u) {
+            for (int c : units_.cells[u]) cell_units_[c].push_back(u);
+            if (units_.cells[u].size() == 9) houses_.push_back(u);
+        }
+        field_.fill(0);
+        used_.assign(U, 0), placed_sum_.assign(U, 0);
+        for (int u = 0; u < U; ++u) num_empty_.push_back(units_.cells[u].size());
+    }
+
+    // マス c の数字
+    int get(int c) const {
+        return field_[c];
+    }
+
+    // マス c に数字 val を入れる
+    void put(int c, int val) {
+        field_[c] = val;
+        for (int u : cell_units_[c]) {
+            used_[u] |= 1 << val;
+            placed_sum_[u] += val;
+            --num_empty_[u];
+        }
+    }
+
+    // マス c の数字を削除する
+    void reset(int c) {
+        int val = field_[c];
+        field_[c] = 0;
+        for (int u : cell_units_[c]) {
+            used_[u] &= ~(1 << val);
+            placed_sum_[u] -= val;
+            ++num_empty_[u];
+        }
+    }
+
+    // マス c に入れられる数字の集合を返す
+    int find_choices(int c) const {
+        int res = ALL;
+        for (int u : cell_units_[c]) {
+            res &= ~used_[u];
+
+            // 和の制約がある場合は、残りの空きマスに残りの和を割り振れる数字に限る
+            if (units_.sum[u] > 0) {
+                int rest = units_.sum[u] - placed_sum_[u];
+                if (rest < 0 || rest > 45) return 0;
+                res &= CAGE_DIGITS[(ALL & ~used_[u]) >> 1][num_empty_[u]][rest];
+            }
+        }
+        return res;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探索する (存在しない場合は -1 を返す)
+    int find_most_constrained() const {
+        int best = -1, min_num = 10;
+        for (int c = 0; c < 81; ++c) {
+            if (field_[c]) continue;
+            int num = __builtin_popcount(find_choices(c));
+            if (num < min_num) {
+                min_num = num, best = c;
+                if (num <= 1) break;
+            }
+        }
+        return best;
+    }
+
+    // naked single と hidden single (9 マスのユニットのみ) を繰り返す
+    // 数字を入れたマスを trail に追加する (矛盾が見つかった場合は false を返す)
+    bool propagate(vector<int>& trail);
+
+    // trail に記録したマスのうち、先頭から size 個より後のマスの数字を削除する
+    void undo(vector<int>& trail, int size) {
+        while ((int)trail.size() > size) {
+            reset(trail.back());
+            trail.pop_back();
+        }
+    }
+};
+
+bool UnitSudoku::propagate(vector<int>& trail) {
+    bool updated = true;
+    while (updated) {
+        updated = false;
+
+        // naked single: 入れられる数字が 1 つしかないマス
+        for (int c = 0; c < 81; ++c) {
+            if (field_[c]) continue;
+            int choices = find_choices(c);
+            if (choices == 0) return false;
+            if (choices & (choices - 1)) continue;
+            put(c, __builtin_ctz(choices));
+            trail.push_back(c);
+            updated = true;
+        }
+
+        // hidden single: 9 マスのユニットの中で、ある数字を入れられるマスが 1 つしかない
+        for (int u : houses_) {
+            int once = 0, twice = 0;
+            for (int c : units_.cells[u]) {
+                if (field_[c]) continue;
+                int choices = find_choices(c);
+                twice |= once & choices;
+                once |= choices;
+            }
+            if ((once | used_[u]) != ALL) return false;
+            int single = once & ~twice;
+            if (single == 0) continue;
+            for (int c : units_.cells[u]) {
+                if (field_[c]) continue;
+                int choices = find_choices(c) & single;
+                if (choices == 0) continue;
+                if (choices & (choices - 1)) return false;
+                put(c, __builtin_ctz(choices));
+                trail.push_back(c);
+                updated = true;
+            }
+        }
+    }
+    return true;
+}
+
+// 数独の解の個数を数えるための再帰関数 (最初に見つけた解を answer に格納する)
+// num が limit に達したら打ち切る (limit が 0 のときは上限なし)
+void dfs_count(UnitSudoku& board, int64_t& num, int64_t limit, array<int, 81>& answer) {
+    if (limit > 0 && num >= limit) return;
+
+    // 数字が 1 つに決まるマスを埋める (矛盾した場合は元に戻して抜ける)
+    vector<int> trail;
+    if (!board.propagate(trail)) {
+        board.undo(trail, 0);
+        return;
+    }
+
+    // 入れられる数字が最も少ない空きマスを探す (存在しない場合は終端条件)
+    int c = board.find_most_constrained();
+    if (c == -1) {
+        if (num++ == 0)
+            for (int i = 0; i < 81; ++i) answer[i] = board.get(i);
+    } else {
+        for (int can_use = board.find_choices(c); can_use; can_use &= can_use - 1) {
+            board.put(c, __builtin_ctz(can_use));
+            dfs_count(board, num, limit, answer);
+            board.reset(c);
+        }
+    }
+    board.undo(trail, 0);
+}
+
+int main() {
+    // 入力: 9 行の盤面 ('*' は空きマス) に続けて、変種の制約を列挙する
+    //   diagonal: 2 本の対角線にも 1 〜 9 が 1 つずつ入る
+    //   antiknight: 桂馬跳びの位置にある 2 マスには同じ数字が入らない
+    //   jigsaw: 続く 9 行で、同じ文字のマスを 1 つのブロックとする (3 × 3 のブロックの代わり)
+    //   cage s c1 c2 ...: マス c1, c2, ... (行と列の番号を 11 〜 99 で表す) の
+    //                     数字は互いに異なり、和が s になる
+    cout << "Sudoku Input: " << endl;
+    vector<string> lines(9);
+    for (int x = 0; x < 9; ++x) {
+        if (!(cin >> lines[x]) || lines[x].size() != 9) {
+            cout << "Invalid input: expected 9 rows of 9 characters" << endl;
+            return 0;
+        }
+    }
+
+    Units units;
+    units.add_rows_and_columns();
+    bool jigsaw = false;
+    string line;
+    while (getline(cin, line)) {
+        istringstream iss(line);
+        string key;
+        if (!(iss >> key)) continue;
+        if (key == "diagonal") {
+            units.add_diagonals();
+        } else if (key == "antiknight") {
+            units.add_anti_knight();
+        } else if (key == "jigsaw") {
+            vector<string> regions(9);
+            for (int x = 0; x < 9; ++x) cin >> regions[x];
+            if (!units.add_regions(regions)) {
+                cout << "Invalid input: jigsaw needs 9 rows of 9 characters "
+                     << "with 9 regions of 9 cells" << endl;
+                return 0;
+            }
+            jigsaw = true;
+        } else if (key == "cage") {
+            // ケージは 1 〜 9 個の互いに異なるマスからなり、和は 1 〜 45 でなければならない
+            int sum = 0, rc;
+            vector<int> cells;
+            if (!(iss >> sum) || sum < 1 || sum > 45) {
+                cout << "Invalid input: cage sum must be 1 to 45" << endl;
+                return 0;
+            }
+            while (iss >> rc) {
+                if (rc / 10 < 1 || rc / 10 > 9 || rc % 10 < 1 || rc % 10 > 9) {
+                    cout << "Invalid input: unknown cell " << rc << " in cage" << endl;
+                    return 0;
+                }
+                int id = cell_id(rc / 10 - 1, rc % 10 - 1);
+                if (find(cells.begin(), cells.end(), id) != cells.end()) {
+                    cout << "Invalid input: cell " << rc << " appears twice in cage" << endl;
+                    return 0;
+                }
+                cells.push_back(id);
+            }
+            if (!iss.eof() || cells.empty() || cells.size() > 9) {
+                cout << "Invalid input: cage must list 1 to 9 cells" << endl;
+                return 0;
+            }
+            units.add(cells, sum);
+        }
+    }
+    if (!jigsaw) units.add_boxes();
+
+    // 盤面の数字を入れる (ユニットに矛盾する場合は解なし)
+    UnitSudoku board(units);
+    bool valid = true;
+    for (int x = 0; x < 9; ++x) {
+        for (int y = 0; y < 9; ++y) {
+            char c = lines[x][y];
+            if (c < '1' || c > '9') continue;
+            if (!(board.find_choices(cell_id(x, y)) >> (c - '0') & 1)) valid = false;
+            board.put(cell_id(x, y), c - '0');
+        }
+    }
+
+    // 解の個数を 2 個まで数える
+    int64_t num = 0;
+    array<int, 81> answer;
+    if (valid) dfs_count(board, num, 2, answer);
+
+    // 解を出力する
+    if (num == 0) {
+        cout << "No solutions." << endl;
+    } else if (num > 1) {
+        cout << "More than one solution." << endl;
+    } else {
+        for (int x = 0; x < 9; ++x) {
+            for (int y = 0; y < 9; ++y)
+                cout << answer[cell_id(x, y)] << " ";
+            cout << endl;
+        }
+    }
+}
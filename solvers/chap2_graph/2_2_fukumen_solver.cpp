@@ -1,7 +1,9 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <set>
+#include <array>
+#include <utility>
+#include <algorithm>
 using namespace std;
 
 // 覆面算を解くためのクラス
@@ -11,8 +13,25 @@ class Fukumenzan {
     vector<string> problem_;
 
     // 計算のための変数
-    vector<vector<int>> board_;  // 文字に数字を入れていく過程
-    set<int> used_;  // すでに使用した数字の集合
+    array<int, 256> letter_val_;  // 各文字に入れた数字
+    int used_;  // すでに使用した数字の集合 (数字 val をビット val で表す)
+    array<bool, 256> is_leading_;  // 各文字がいずれかの行の最上桁にあるかどうか
+
+    // 各桁に最下行以外で現れる文字 (重複を除き、上の行から順に並べる)
+    vector<vector<char>> col_letters_;
+
+    // 各文字が最下行以外で現れる桁と、その桁での出現回数
+    array<vector<pair<int, int>>, 256> letter_cols_;
+
+    // 各桁について、最下行以外の数字を入れた文字の和と、数字を入れていない文字の個数
+    // (文字に数字を入れるたびに、その文字が現れるすべての桁を更新する)
+    vector<int> sum_, num_free_;
+
+    // 各桁への繰り上がり (下の桁の計算が合った時点で決まる)
+    vector<int> carry_;
+
+    // 各桁に入ってよい繰り上がりの最大値 (最上桁より上への繰り上がりは 0)
+    vector<int> max_carry_;
 
     // 未確定であることを表す数字
     const int NOTIN = -1;
@@ -22,14 +41,7 @@ class Fukumenzan {
     Fukumenzan(const vector<string>& input) : problem_(input) { }
 
     // 覆面算を解く過程を初期化する
-    void init() {
-        // 文字に数字を入れていく盤面 board 全体を NOTIN で初期化する
-        board_.resize(problem_.size());
-        for (int i = 0; i < problem_.size(); ++i) {
-            board_[i].assign(problem_[i].size(), NOTIN);
-        }
-        used_.clear();
-    }
+    void init();
 
     // 覆面算全体の行数を返す
     int get_size() const { return problem_.size(); }
@@ -41,13 +53,19 @@ class Fukumenzan {
     int get_digit(int row) const { return problem_[row].size(); }
 
     // 数字 val がすでに使われているかどうかを返す
-    bool is_used(int val) const { return used_.count(val); }
+    bool is_used(int val) const { return used_ >> val & 1; }
+
+    // 文字 c が最上桁にあるかどうか (0 を入れられない) を返す
+    bool is_leading(char c) const { return is_leading_[(unsigned char)c]; }
+
+    // 文字 c に入れた数字を返す
+    int get_letter_val(char c) const { return letter_val_[(unsigned char)c]; }
 
     // 覆面算の上から row 行め、右から digit 桁めに入れた数字を返す
     int get_val(int row, int digit) const {
         // digit 桁めが row 行めの文字列からはみ出す場合は 0 とする
         if (digit >= get_digit(row)) return 0;
-        return board_[row][get_digit(row) - 1 - digit];
+        return get_letter_val(get_char(row, digit));
     }
 
     // 覆面算の上から row 行め、右から digit 桁めの文字を返す
@@ -55,113 +73,154 @@ class Fukumenzan {
         return problem_[row][get_digit(row) - 1 - digit];
     }
 
+    // 右から digit 桁めの和 (繰り上がりと、最下行以外の行の数字の和) を返す
+    // 最下行以外のすべての文字に数字が入っているときのみ意味をもつ
+    int get_total(int digit) const { return carry_[digit] + sum_[digit]; }
+
+    // 右から digit 桁めへの繰り上がりを返す
+    int get_carry(int digit) const { return carry_[digit]; }
+
+    // 右から digit 桁めへの繰り上がりを設定する
+    void set_carry(int digit, int carry) { carry_[digit] = carry; }
+
+    // 右から digit 桁めの最下行以外で、数字を入れていない文字を返す (ない場合は 0)
+    char find_free_letter(int digit) const {
+        for (char c : col_letters_[digit])
+            if (get_letter_val(c) == NOTIN) return c;
+        return 0;
+    }
+
     // 覆面算の計算結果を出力する
     void print() const {
-        for (const vector<int>& vec : board_) {
-            for (int v : vec) cout << v;
+        for (const string& str : problem_) {
+            for (char c : str) cout << get_letter_val(c);
             cout << endl;
         }
     }
 
-    // row 行め、右から digit 桁めの文字に数値 val を入れる
-    void set_val(int row, int digit, int val);
+    // 文字 c に数値 val を入れる
+    void set_val(char c, int val);
 
-    // row 行め、右から digit 桁めの文字に入れていた数字を削除する
-    void reset_val(int row, int digit, int val);
+    // 文字 c に入れていた数字 val を削除する
+    void reset_val(char c, int val);
 
-    // 覆面文字に入れた数字によって計算が合うかどうかを確認する
-    bool is_valid();
+    // 右から digit 桁めの残りの文字に数字を入れて、計算が合う可能性があるかどうかを確認する
+    bool can_reach(int digit) const;
 };
 
-// row 行め、右から digit 桁めの文字に数字 val を入れる
-void Fukumenzan::set_val(int row, int digit, int val) {
-    // 該当の文字を求める
-    char c = get_char(row, digit);
-
-    // 文字が c であるすべてのマスに数字 val を入れる
-    for (int r = 0; r < get_size(); ++r) {
-        for (int d = 0; d < get_digit(r); ++d) {
-            if (problem_[r][d] == c) board_[r][d] = val;
+// 覆面算を解く過程を初期化する
+void Fukumenzan::init() {
+    // すべての文字を NOTIN で初期化する
+    letter_val_.fill(NOTIN);
+    used_ = 0;
+
+    is_leading_.fill(false);
+    for (const string& str : problem_) is_leading_[(unsigned char)str[0]] = true;
+
+    // 各桁の、最下行以外の文字ごとの出現回数を求める
+    sum_.assign(get_digit() + 1, 0);
+    num_free_.assign(get_digit() + 1, 0);
+    carry_.assign(get_digit() + 1, 0);
+    col_letters_.assign(get_digit(), vector<char>());
+    for (auto& cols : letter_cols_) cols.clear();
+    for (int digit = 0; digit < get_digit(); ++digit) {
+        for (int row = 0; row < get_size() - 1; ++row) {
+            if (digit >= get_digit(row)) continue;
+            char c = get_char(row, digit);
+            auto& cols = letter_cols_[(unsigned char)c];
+            if (cols.empty() || cols.back().first != digit) {
+                cols.emplace_back(digit, 0);
+                col_letters_[digit].push_back(c);
+            }
+            ++cols.back().second;
+            ++num_free_[digit];
         }
     }
-    used_.insert(val);  // 数字 val を使用済みとする
-}
-
-// row 行め、右から digit 桁めの文字に入れていた数字を削除する
-void Fukumenzan::reset_val(int row, int digit, int val) {
-    // 該当の文字を求める
-    char c = get_char(row, digit);
 
-    // 文字が c であるすべてのマスの数字を削除する
-    for (int r = 0; r < get_size(); ++r) {
-        for (int d = 0; d < get_digit(r); ++d) {
-            if (problem_[r][d] == c) board_[r][d] = -1;
-        }
-    }
-    used_.erase(val);  // 数字 val を今後使用可能とする
+    // 各桁への繰り上がりの上限は、上の桁から順に求める
+    // (桁 d の和は 10 * max_carry_[d + 1] + 9 以下なので、桁 d への繰り上がりも同様)
+    max_carry_.assign(get_digit() + 1, 0);
+    for (int d = get_digit() - 1; d >= 0; --d)
+        max_carry_[d] = min(10 * max_carry_[d + 1] + 9, 1000000);
 }
 
-// 覆面文字に入れた数字によって計算が合うかどうかを確認する
-bool Fukumenzan::is_valid() {
-    // 最上桁に 0 があってはいけない
-    for (const vector<int>& val : board_) {
-        if (val[0] == 0) return false;
+// 文字 c に数字 val を入れる
+// (各マスの数字は文字に入れた数字から求めるので、文字と各桁の和を更新するだけでよい)
+void Fukumenzan::set_val(char c, int val) {
+    letter_val_[(unsigned char)c] = val;
+    used_ |= 1 << val;  // 数字 val を使用済みとする
+    for (const auto& [digit, num] : letter_cols_[(unsigned char)c]) {
+        sum_[digit] += num * val;
+        num_free_[digit] -= num;
     }
+}
 
-    // 右から 0 桁めから順に計算していく
-    int kuriagari = 0;  // 繰り上がりの値
-    for (int digit = 0; digit < get_digit(); ++digit) {
-        // 右から digit 桁めの、最下行以外の行の和を計算する
-        int sum = 0;
-        for (int row = 0; row < get_size(); ++row) {
-            // まだ数字が入っていない部分に来たらその場で終了する
-            if (get_val(row, digit) == NOTIN) return true;
-
-            // 最下段以外を足す
-            if (row != get_size() - 1) sum += get_val(row, digit);
-        }
-
-        // 前の桁からの繰り上がりを足して、新たな繰り上がりを計算する
-        sum += kuriagari;
-        kuriagari = sum / 10;
-
-        // 最下行に来るべき数字 (sum % 10) が合っているかを確かめる
-        if (sum % 10 != get_val(get_size() - 1, digit)) return false;
+// 文字 c に入れていた数字 val を削除する
+void Fukumenzan::reset_val(char c, int val) {
+    letter_val_[(unsigned char)c] = NOTIN;
+    used_ &= ~(1 << val);  // 数字 val を今後使用可能とする
+    for (const auto& [digit, num] : letter_cols_[(unsigned char)c]) {
+        sum_[digit] -= num * val;
+        num_free_[digit] += num;
     }
+}
 
-    // 最後に繰り上がりが残ってはいけない
-    return (kuriagari == 0);
+// 右から digit 桁めの残りの文字に数字を入れて、計算が合う可能性があるかどうかを確認する
+bool Fukumenzan::can_reach(int digit) const {
+    // 数字を入れていない文字には 0 〜 9 が入るとして、この桁の和の範囲を求める
+    // 次の桁への繰り上がりが上限を超えてはいけない
+    int lo = get_total(digit);
+    int hi = min(lo + 9 * num_free_[digit], 10 * max_carry_[digit + 1] + 9);
+    if (lo > hi) return false;
+
+    // 最下行の数字が決まっている場合は、和の 1 の位がそれに一致しなければならない
+    int res = get_val(get_size() - 1, digit);
+    if (res == NOTIN) return true;
+    return lo + (res - lo % 10 + 10) % 10 <= hi;
 }
 
 // 深さ優先探索のための再帰関数
-// 上から row 行め、右から digit 桁めに数字を入れようとする
-void dfs(Fukumenzan& fu, int row, int digit, vector<Fukumenzan>& res) {
-    // 終端条件: すべての文字に数字が入ったとき
-    if (row == 0 && digit == fu.get_digit()) {
-        res.push_back(fu);  // 答えに格納する
+// 右から digit 桁めの文字に数字を入れようとする
+// 下の桁から順に、各桁では最下行以外の文字に上の行から順に数字を入れ、
+// それらがすべて決まったら、最下行の数字を桁の和から求めて次の桁へ進む
+void dfs(Fukumenzan& fu, int digit, vector<Fukumenzan>& res) {
+    // 終端条件: すべての桁の計算が合い、最上桁から繰り上がりが残っていないとき
+    if (digit == fu.get_digit()) {
+        if (fu.get_carry(digit) == 0) res.push_back(fu);  // 答えに格納する
         return;
     }
 
-    // 再帰呼び出しのための次のマスを求める
-    int next_row = row + 1, next_digit = digit;
-    if (next_row == fu.get_size()) {
-        next_row = 0, next_digit = digit + 1;
+    // 計算が合う見込みがなければ打ち切る
+    if (!fu.can_reach(digit)) return;
+
+    char c = fu.find_free_letter(digit);
+    if (c == 0) {
+        // 最下行の数字は、桁の和の 1 の位として決まる
+        int row = fu.get_size() - 1;
+        int total = fu.get_total(digit), val = total % 10;
+        fu.set_carry(digit + 1, total / 10);
+        int cur = fu.get_val(row, digit);
+        char rc = fu.get_char(row, digit);
+        if (cur != -1) {
+            if (cur == val) dfs(fu, digit + 1, res);
+        } else if (!fu.is_used(val) && !(val == 0 && fu.is_leading(rc))) {
+            fu.set_val(rc, val);
+            dfs(fu, digit + 1, res);
+            fu.reset_val(rc, val);
+        }
+        return;
     }
 
-    // すでに数字が入っているかどうかで場合分け
-    if (fu.get_val(row, digit) != -1) {
-        dfs(fu, next_row, next_digit, res);
-    } else {
-        for (int val = 0; val <= 9; ++val) {
-            // すでに使用済みの数字は使えない
-            if (fu.is_used(val)) continue;
-
-            fu.set_val(row, digit, val);  // 文字に数字を入れる
-            if (fu.is_valid()) {
-                dfs(fu, next_row, next_digit, res);
-            }
-            fu.reset_val(row, digit, val);  // 文字から数字を削除する
-        }
+    for (int val = 0; val <= 9; ++val) {
+        // すでに使用済みの数字は使えない
+        if (fu.is_used(val)) continue;
+
+        // 最上桁に 0 があってはいけない
+        if (val == 0 && fu.is_leading(c)) continue;
+
+        fu.set_val(c, val);  // 文字に数字を入れる
+        dfs(fu, digit, res);
+        fu.reset_val(c, val);  // 文字から数字を削除する
     }
 }
 
@@ -179,7 +238,7 @@ vector<Fukumenzan> solve(Fukumenzan& fu) {
 
     // 深さ優先探索を開始する
     vector<Fukumenzan> res;
-    dfs(fu, 0, 0, res);
+    dfs(fu, 0, res);
     return res;
 }
 
@@ -0,0 +1,224 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdlib>
+using namespace std;
+
+// 覆面算を 1 本の線形方程式に変換して解くためのクラス
+// 各文字 c の係数 coef[c] を「最下行以外での位取りの和 - 最下行での位取りの和」とすると、
+// 覆面算は Σ coef[c] * (文字 c の数字) = 0 と表せる
+// 桁ごとの計算をしないので、行数が多い覆面算でも各文字の係数を 1 度求めるだけでよい
+class LinearFukumenzan {
+ private:
+    // 覆面算の文字列を格納した配列
+    vector<string> problem_;
+
+    // 現れる文字と、その係数と、最上桁にある (0 を入れられない) かどうか
+    // 文字は係数の絶対値の大きい順に並べる
+    string letters_;
+    vector<int64_t> coef_;
+    vector<bool> leading_;
+
+    // 文字 letters_[i] 以降の項の和がとりうる最小値と最大値
+    // (数字が互いに異なることは考えずに、各文字に 0 〜 9 (最上桁は 1 〜 9) を入れる)
+    vector<int64_t> rest_min_, rest_max_;
+
+    // 計算のための変数
+    vector<int> vals_;  // 各文字に入れた数字
+    int used_;  // すでに使用した数字の集合 (数字 val をビット val で表す)
+    vector<vector<int>> res_;  // 解 (各文字に入れた数字)
+
+    // 深さ優先探索のための再帰関数 (i 番めの文字に数字を入れる、sum はそれまでの項の和)
+    void dfs(int i, int64_t sum);
+
+    // 文字 letters_[first], ..., letters_[last - 1] に互いに異なる数字を入れる方法をすべて求め、
+    // 各方法の「項の和」「使用した数字の集合」「各文字に入れた数字」を func に渡す
+    template<class Func> void enumerate(int first, int last, Func func);
+
+ public:
+    // コンストラクタ (文字の係数を求める)
+    LinearFukumenzan(const vector<string>& input);
+
+    // 係数の絶対値の大きい文字から順に数字を入れ、項の和の範囲で枝刈りして解く
+    vector<vector<int>> solve();
+
+    // 文字を前半と後半に分け、それぞれの数字の入れ方を列挙して項の和が打ち消し合う組を探す
+    vector<vector<int>> solve_by_meet_in_the_middle();
+
+    // 解 vals (各文字に入れた数字) に対する計算結果を、各行をつなげた文字列で返す
+    string to_digits(const vector<int>& vals) const {
+        string res;
+        for (const string& str : problem_)
+            for (char c : str) res += char('0' + vals[letters_.find(c)]);
+        return res;
+    }
+
+    // 解 vals (各文字に入れた数字) に対する計算結果を出力する
+    void print(const vector<int>& vals) const;
+};
+
+// コンストラクタ (文字の係数を求める)
+LinearFukumenzan::LinearFukumenzan(const vector<string>& input) : problem_(input) {
+    // 各文字の係数を求める (最下行の位取りは負にする)
+    array<int64_t, 256> coef{};
+    array<bool, 256> appear{}, leading{};
+    for (int row = 0; row < (int)problem_.size(); ++row) {
+        const string& str = problem_[row];
+        int sign = (row == (int)problem_.size() - 1 ? -1 : 1);
+        int64_t pow10 = 1;
+        for (int d = (int)str.size() - 1; d >= 0; --d, pow10 *= 10) {
+            unsigned char c = str[d];
+            coef[c] += sign * pow10;
+            appear[c] = true;
+        }
+        leading[(unsigned char)str[0]] = true;
+    }
+
+    // 係数の絶対値の大きい順に並べる
+    for (int c = 0; c < 256; ++c)
+        if (appear[c]) letters_ += char(c);
+    stable_sort(letters_.begin(), letters_.end(), [&](char a, char b) {
+        return llabs(coef[(unsigned char)a]) > llabs(coef[(unsigned char)b]);
+    });
+    for (char c : letters_) {
+        coef_.push_back(coef[(unsigned char)c]);
+        leading_.push_back(leading[(unsigned char)c]);
+    }
+
+    // 後ろの文字から順に、項の和がとりうる範囲を求める
+    int L = letters_.size();
+    rest_min_.assign(L + 1, 0), rest_max_.assign(L + 1, 0);
+    for (int i = L - 1; i >= 0; --i) {
+        int64_t lo = coef_[i] * (leading_[i] ? 1 : 0), hi = coef_[i] * 9;
+        rest_min_[i] = rest_min_[i + 1] + min(lo, hi);
+        rest_max_[i] = rest_max_[i + 1] + max(lo, hi);
+    }
+}
+
+// 深さ優先探索のための再帰関数 (i 番めの文字に数字を入れる、sum はそれまでの項の和)
+void LinearFukumenzan::dfs(int i, int64_t sum) {
+    // 終端条件: すべての文字に数字が入ったとき
+    if (i == (int)letters_.size()) {
+        if (sum == 0) res_.push_back(vals_);
+        return;
+    }
+
+    // 残りの文字に何を入れても和が 0 にならなければ打ち切る
+    if (sum + rest_min_[i] > 0 || sum + rest_max_[i] < 0) return;
+
+    for (int val = (leading_[i] ? 1 : 0); val <= 9; ++val) {
+        // すでに使用済みの数字は使えない
+        if (used_ >> val & 1) continue;
+
+        vals_[i] = val;
+        used_ |= 1 << val;
+        dfs(i + 1, sum + coef_[i] * val);
+        used_ &= ~(1 << val);
+    }
+}
+
+// 係数の絶対値の大きい文字から順に数字を入れ、項の和の範囲で枝刈りして解く
+vector<vector<int>> LinearFukumenzan::solve() {
+    res_.clear();
+    if (letters_.size() > 10) return res_;  // 文字が 11 種類以上ならば解なし
+    vals_.assign(letters_.size(), -1);
+    used_ = 0;
+    dfs(0, 0);
+    return res_;
+}
+
+// 文字 letters_[first], ..., letters_[last - 1] に互いに異なる数字を入れる方法をすべて求め、
+// 各方法の「項の和」「使用した数字の集合」「各文字に入れた数字」を func に渡す
+template<class Func> void LinearFukumenzan::enumerate(int first, int last, Func func) {
+    vector<int> vals(last - first, -1);
+    auto rec = [&](auto self, int i, int64_t sum, int used) -> void {
+        if (i == last) {
+            func(sum, used, vals);
+            return;
+        }
+        for (int val = (leading_[i] ? 1 : 0); val <= 9; ++val) {
+            if (used >> val & 1) continue;
+            vals[i - first] = val;
+            self(self, i + 1, sum + coef_[i] * val, used | 1 << val);
+        }
+    };
+    rec(rec, first, 0, 0);
+}
+
+// 文字を前半と後半に分け、それぞれの数字の入れ方を列挙して項の和が打ち消し合う組を探す
+vector<vector<int>> LinearFukumenzan::solve_by_meet_in_the_middle() {
+    vector<vector<int>> res;
+    int L = letters_.size();
+    if (L > 10) return res;  // 文字が 11 種類以上ならば解なし
+    int half = L / 2;
+
+    // 後半の文字の数字の入れ方を、項の和ごとにまとめる
+    struct Half {
+        int used;
+        vector<int> vals;
+    };
+    unordered_map<int64_t, vector<Half>> table;
+    enumerate(half, L, [&](int64_t sum, int used, const vector<int>& vals) {
+        table[sum].push_back({used, vals});
+    });
+
+    // 前半の数字の入れ方ごとに、項の和が打ち消し合い、数字が重ならない後半を探す
+    enumerate(0, half, [&](int64_t sum, int used, const vector<int>& vals) {
+        auto it = table.find(-sum);
+        if (it == table.end()) return;
+        for (const Half& h : it->second) {
+            if (used & h.used) continue;
+            vector<int> sol = vals;
+            sol.insert(sol.end(), h.vals.begin(), h.vals.end());
+            res.push_back(sol);
+        }
+    });
+    return res;
+}
+
+// 解 vals (各文字に入れた数字) に対する計算結果を出力する
+void LinearFukumenzan::print(const vector<int>& vals) const {
+    for (const string& str : problem_) {
+        for (char c : str) cout << vals[letters_.find(c)];
+        cout << endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    // 使い方: fukumen_solver_by_linear [--mitm]
+    //   --mitm が指定された場合は、半分全列挙 (meet-in-the-middle) で解く
+    bool mitm = (argc >= 2 && string(argv[1]) == "--mitm");
+
+    // 入力
+    cout << "Fukumenzan Input: " << endl;
+    int N;  // 行数
+    cin >> N;
+    vector<string> input(N);
+    for (int i = 0; i < N; ++i) cin >> input[i];
+
+    // 係数と項の和の範囲が 64 ビット整数に収まる桁数に限る
+    for (const string& str : input) {
+        if (str.size() > 15) {
+            cout << "Too many digits: " << str << endl;
+            return 0;
+        }
+    }
+
+    // 線形方程式に変換して解く
+    LinearFukumenzan fu(input);
+    vector<vector<int>> res = mitm ? fu.solve_by_meet_in_the_middle() : fu.solve();
+
+    // 解を出力 (探索方法によらず同じ順になるように、計算結果の辞書順に並べる)
+    sort(res.begin(), res.end(), [&](const vector<int>& a, const vector<int>& b) {
+        return fu.to_digits(a) < fu.to_digits(b);
+    });
+    cout << "The num of solutions: " << res.size() << endl;
+    for (int i = 0; i < (int)res.size(); ++i) {
+        cout << i << " th solution:" << endl;
+        fu.print(res[i]);
+    }
+}